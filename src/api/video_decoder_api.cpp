@@ -134,6 +134,24 @@ bool VideoDecoderAPI::DecodeBuffer(const void* buffer,
   return decoder_->DecodeBuffer(buffer, size, id, buffer_pts);
 }
 
+void* VideoDecoderAPI::AcquireInputBuffer(size_t min_size) {
+  if (!decoder_) {
+    MCIL_ERROR_PRINT(" Error: decoder (%p) ", decoder_.get());
+    return nullptr;
+  }
+  return decoder_->AcquireInputBuffer(min_size);
+}
+
+bool VideoDecoderAPI::CommitInputBuffer(size_t size,
+                                        const int32_t id,
+                                        int64_t buffer_pts) {
+  if (!decoder_) {
+    MCIL_ERROR_PRINT(" Error: decoder (%p) ", decoder_.get());
+    return false;
+  }
+  return decoder_->CommitInputBuffer(size, id, buffer_pts);
+}
+
 bool VideoDecoderAPI::FlushInputBuffers() {
   if (!decoder_) {
     MCIL_ERROR_PRINT(" Error: decoder (%p) ", decoder_.get());
@@ -227,6 +245,15 @@ bool VideoDecoderAPI::AllocateOutputBuffers(
   return decoder_->AllocateOutputBuffers(count, buffers);
 }
 
+bool VideoDecoderAPI::ImportBufferForPicture(int32_t pic_buffer_id,
+                                             scoped_refptr<VideoFrame> frame) {
+  if (!decoder_) {
+    MCIL_ERROR_PRINT(" Error: decoder (%p) ", decoder_.get());
+    return false;
+  }
+  return decoder_->ImportBufferForPicture(pic_buffer_id, std::move(frame));
+}
+
 bool VideoDecoderAPI::CanCreateEGLImageFrom(VideoPixelFormat pixel_format) {
   if (!decoder_) {
     MCIL_ERROR_PRINT(" Error: decoder (%p) ", decoder_.get());
@@ -245,6 +272,20 @@ void VideoDecoderAPI::OnEGLImagesCreationCompleted() {
   return decoder_->OnEGLImagesCreationCompleted();
 }
 
+bool VideoDecoderAPI::GetStats(DecoderStats* stats) {
+  if (!decoder_) {
+    MCIL_ERROR_PRINT(" Error: decoder (%p) ", decoder_.get());
+    return false;
+  }
+
+  return decoder_->GetStats(stats);
+}
+
+// static
+bool VideoDecoderAPI::GetResourceStats(ResourceStats* stats) {
+  return VideoResource::GetInstance().GetStats(stats);
+}
+
 #if defined (ENABLE_REACQUIRE)
 void VideoDecoderAPI::OnResolutionChanged(uint32_t width, uint32_t height) {
   if (codec_type_ == VIDEO_CODEC_NONE) {
@@ -43,6 +43,8 @@ class VideoDecoderAPI {
 
   bool DecodeBuffer(const void* buffer, size_t size,
                     const int32_t id, int64_t buffer_pts);
+  void* AcquireInputBuffer(size_t min_size);
+  bool CommitInputBuffer(size_t size, const int32_t id, int64_t buffer_pts);
   bool FlushInputBuffers();
   bool DidFlushBuffersDone();
 
@@ -58,9 +60,19 @@ class VideoDecoderAPI {
   size_t GetFreeBuffersCount(QueueType queue_type);
   bool AllocateOutputBuffers(uint32_t count,
                              std::vector<WritableBufferRef*>& buffers);
+  bool ImportBufferForPicture(int32_t pic_buffer_id,
+                              scoped_refptr<VideoFrame> frame);
   bool CanCreateEGLImageFrom(VideoPixelFormat pixel_format);
   void OnEGLImagesCreationCompleted();
 
+  // Per buffer latency percentiles since Initialize(). Safe to call from
+  // any thread.
+  bool GetStats(DecoderStats* stats);
+
+  // Resource acquisition latencies of all codecs in the process, split by
+  // phase. Safe to call from any thread.
+  static bool GetResourceStats(ResourceStats* stats);
+
  private:
   #if defined (ENABLE_REACQUIRE)
   void OnResolutionChanged(uint32_t width, uint32_t height);
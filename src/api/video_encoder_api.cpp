@@ -205,4 +205,18 @@ bool VideoEncoderAPI::NegotiateInputFormat(VideoPixelFormat format,
   return encoder_->NegotiateInputFormat(format, frame_size);
 }
 
+bool VideoEncoderAPI::GetStats(EncoderStats* stats) {
+  if (!encoder_) {
+    MCIL_ERROR_PRINT(" Error: encoder (%p) ", encoder_.get());
+    return false;
+  }
+
+  return encoder_->GetStats(stats);
+}
+
+// static
+bool VideoEncoderAPI::GetResourceStats(ResourceStats* stats) {
+  return VideoResource::GetInstance().GetStats(stats);
+}
+
 }  // namespace mcil
@@ -54,6 +54,14 @@ class VideoEncoderAPI {
   bool NegotiateInputFormat(VideoPixelFormat format,
                             const Size& frame_size);
 
+  // Per frame latency percentiles and queue depths since Initialize(). Safe
+  // to call from any thread.
+  bool GetStats(EncoderStats* stats);
+
+  // Resource acquisition latencies of all codecs in the process, split by
+  // phase. Safe to call from any thread.
+  static bool GetResourceStats(ResourceStats* stats);
+
  private:
   VideoEncoderClient* client_;
   scoped_refptr<VideoEncoder> encoder_;
@@ -226,6 +226,55 @@ VideoCodec VideoCodecProfileToVideoCodec(VideoCodecProfile profile);
 
 typedef std::vector<SupportedProfile> SupportedProfiles;
 typedef std::chrono::system_clock::time_point ChronoTime;
+typedef std::chrono::steady_clock::time_point MonotonicTime;
+
+class LatencyStats {
+ public:
+  LatencyStats() = default;
+  ~LatencyStats() = default;
+
+  uint64_t count = 0;
+  uint64_t p50_us = 0;
+  uint64_t p99_us = 0;
+  uint64_t max_us = 0;
+};
+
+class QueueDepthStats {
+ public:
+  QueueDepthStats() = default;
+  ~QueueDepthStats() = default;
+
+  uint64_t samples = 0;
+  // Number of samples that found the queue empty.
+  uint64_t empty_samples = 0;
+  uint32_t current = 0;
+  uint32_t max = 0;
+  // Mean depth over all samples, scaled by 100.
+  uint64_t mean_x100 = 0;
+};
+
+/* Resource acquisition latency, per phase of Acquire()/Reacquire() */
+class ResourceStats {
+ public:
+  ResourceStats() = default;
+  ~ResourceStats() = default;
+
+  // Resource calculator query for the stream.
+  LatencyStats calculate;
+  // Building the JSON request payload.
+  LatencyStats build_request;
+  // Synchronous acquire/reacquire round trip to the resource manager.
+  LatencyStats rmc_call;
+  // Parsing the response.
+  LatencyStats parse_ports;
+  LatencyStats parse_resources;
+  // Waiting for another Acquire/Reacquire/Release to finish.
+  LatencyStats lock_wait;
+  // The whole Acquire()/Reacquire() call.
+  LatencyStats total;
+  uint64_t lock_contentions = 0;
+  uint64_t failures = 0;
+};
 
 }  //  namespace mcil
 
@@ -80,6 +80,22 @@ class DecoderClientConfig {
   bool should_control_buffer_feed = false;
 };
 
+/* Decoder latency statistics, per input buffer id */
+class DecoderStats {
+ public:
+  DecoderStats() = default;
+  ~DecoderStats() = default;
+
+  // DecodeBuffer() until the input buffer is queued to the device.
+  LatencyStats input_wait;
+  // Input buffer queued until it is dequeued again by the device.
+  LatencyStats input_device;
+  // Input buffer queued until its decoded frame is dequeued.
+  LatencyStats decode;
+  // DecodeBuffer() until the decoded frame is sent to the client.
+  LatencyStats total;
+};
+
 }  // namespace mcil
 
 #endif  // SRC_BASE_DECODER_TYPES_H_
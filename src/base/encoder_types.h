@@ -61,6 +61,28 @@ class EncoderClientConfig {
   bool should_inject_sps_and_pps = false;
 };
 
+/* Encoder latency and queue occupancy statistics */
+class EncoderStats {
+ public:
+  EncoderStats() = default;
+  ~EncoderStats() = default;
+
+  // EncodeFrame() until the frame is queued to the device.
+  LatencyStats input_wait;
+  // Input frame queued until its bitstream buffer is dequeued.
+  LatencyStats encode;
+  // Time spent in the client's BitstreamBufferReady().
+  LatencyStats deliver;
+  // EncodeFrame() until BitstreamBufferReady() returns.
+  LatencyStats total;
+
+  // Frames waiting for a free device input buffer.
+  QueueDepthStats pending_frames;
+  // Buffers owned by the device on each queue.
+  QueueDepthStats input_queued;
+  QueueDepthStats output_queued;
+};
+
 }  // namespace mcil
 
 #endif  // SRC_BASE_ENCODER_TYPES_H_
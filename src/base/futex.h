@@ -0,0 +1,47 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef SRC_BASE_FUTEX_H_
+#define SRC_BASE_FUTEX_H_
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+
+namespace mcil {
+
+static_assert(sizeof(std::atomic<int32_t>) == sizeof(int32_t),
+              "futex word must be a plain int");
+
+// Sleeps while |word| holds |expected|. May return spuriously, callers
+// recheck their condition.
+inline void FutexWait(std::atomic<int32_t>* word, int32_t expected) {
+  syscall(SYS_futex, reinterpret_cast<int32_t*>(word), FUTEX_WAIT_PRIVATE,
+          expected, nullptr, nullptr, 0);
+}
+
+// Wakes one thread sleeping on |word|.
+inline void FutexWake(std::atomic<int32_t>* word) {
+  syscall(SYS_futex, reinterpret_cast<int32_t*>(word), FUTEX_WAKE_PRIVATE,
+          1, nullptr, nullptr, 0);
+}
+
+}  // namespace mcil
+
+#endif  // SRC_BASE_FUTEX_H_
@@ -0,0 +1,140 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef SRC_BASE_INLINE_VECTOR_H_
+#define SRC_BASE_INLINE_VECTOR_H_
+
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mcil {
+
+// std::vector like container with a fixed capacity and inline storage, for
+// small arrays bounded by a known maximum, e.g. the planes of a VideoFrame.
+// It never allocates, so building, copying and destroying its owner does
+// not touch the heap. Growing it past kCapacity is a programming error: it
+// asserts, and the new element is dropped in release builds.
+template <typename T, size_t kCapacity>
+class InlineVector {
+ public:
+  static_assert(std::is_trivially_destructible<T>::value,
+                "elements past size() are kept, not destroyed");
+
+  using value_type = T;
+  using size_type = size_t;
+  using reference = T&;
+  using const_reference = const T&;
+  using iterator = T*;
+  using const_iterator = const T*;
+
+  InlineVector() = default;
+  InlineVector(std::initializer_list<T> values) {
+    assign(values.begin(), values.end());
+  }
+  InlineVector(const std::vector<T>& values) {
+    assign(values.begin(), values.end());
+  }
+
+  InlineVector& operator=(const std::vector<T>& values) {
+    assign(values.begin(), values.end());
+    return *this;
+  }
+
+  template <typename InputIterator>
+  void assign(InputIterator first, InputIterator last) {
+    clear();
+    for (; first != last; ++first)
+      push_back(*first);
+  }
+
+  size_type size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  static constexpr size_type capacity() { return kCapacity; }
+  static constexpr size_type max_size() { return kCapacity; }
+  void reserve(size_type count) { assert(count <= kCapacity); }
+
+  void clear() { size_ = 0; }
+  void resize(size_type count) {
+    assert(count <= kCapacity);
+    if (count > kCapacity)
+      count = kCapacity;
+    for (size_type i = size_; i < count; ++i)
+      data_[i] = T();
+    size_ = count;
+  }
+
+  void push_back(const T& value) {
+    if (CanGrow())
+      data_[size_++] = value;
+  }
+  template <typename... Args>
+  void emplace_back(Args&&... args) {
+    if (CanGrow())
+      data_[size_++] = T(std::forward<Args>(args)...);
+  }
+  void pop_back() {
+    assert(size_ > 0);
+    --size_;
+  }
+
+  reference operator[](size_type index) {
+    assert(index < size_);
+    return data_[index];
+  }
+  const_reference operator[](size_type index) const {
+    assert(index < size_);
+    return data_[index];
+  }
+  reference front() { return (*this)[0]; }
+  const_reference front() const { return (*this)[0]; }
+  reference back() { return (*this)[size_ - 1]; }
+  const_reference back() const { return (*this)[size_ - 1]; }
+
+  T* data() { return data_; }
+  const T* data() const { return data_; }
+  iterator begin() { return data_; }
+  const_iterator begin() const { return data_; }
+  iterator end() { return data_ + size_; }
+  const_iterator end() const { return data_ + size_; }
+
+  bool operator==(const InlineVector& rhs) const {
+    if (size_ != rhs.size_)
+      return false;
+    for (size_type i = 0; i < size_; ++i) {
+      if (!(data_[i] == rhs.data_[i]))
+        return false;
+    }
+    return true;
+  }
+  bool operator!=(const InlineVector& rhs) const { return !(*this == rhs); }
+
+ private:
+  bool CanGrow() const {
+    assert(size_ < kCapacity);
+    return size_ < kCapacity;
+  }
+
+  T data_[kCapacity] = {};
+  size_type size_ = 0;
+};
+
+}  // namespace mcil
+
+#endif  // SRC_BASE_INLINE_VECTOR_H_
@@ -0,0 +1,146 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "latency_histogram.h"
+
+#include <algorithm>
+
+namespace mcil {
+
+LatencyHistogram::LatencyHistogram() {
+  Reset();
+}
+
+void LatencyHistogram::Record(uint64_t value_us) {
+  buckets_[BucketIndex(value_us)].fetch_add(1, std::memory_order_relaxed);
+
+  uint64_t max_us = max_us_.load(std::memory_order_relaxed);
+  while ((value_us > max_us) &&
+         !max_us_.compare_exchange_weak(max_us, value_us,
+                                        std::memory_order_relaxed)) {
+  }
+}
+
+void LatencyHistogram::Record(MonotonicTime start, MonotonicTime end) {
+  if (end < start)
+    return;
+
+  Record(static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          end - start).count()));
+}
+
+LatencyStats LatencyHistogram::Snapshot() const {
+  uint64_t counts[kBucketCount];
+  LatencyStats stats;
+  for (size_t i = 0; i < kBucketCount; ++i) {
+    counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    stats.count += counts[i];
+  }
+
+  if (stats.count == 0)
+    return stats;
+
+  stats.max_us = max_us_.load(std::memory_order_relaxed);
+
+  const uint64_t p50_rank = (stats.count + 1) / 2;
+  const uint64_t p99_rank = stats.count - (stats.count / 100);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBucketCount; ++i) {
+    if (counts[i] == 0)
+      continue;
+
+    uint64_t previous = seen;
+    seen += counts[i];
+    uint64_t value = std::min(BucketUpperBound(i), stats.max_us);
+    if ((previous < p50_rank) && (seen >= p50_rank))
+      stats.p50_us = value;
+    if ((previous < p99_rank) && (seen >= p99_rank)) {
+      stats.p99_us = value;
+      break;
+    }
+  }
+
+  return stats;
+}
+
+void LatencyHistogram::Reset() {
+  for (auto& bucket : buckets_)
+    bucket.store(0, std::memory_order_relaxed);
+  max_us_.store(0, std::memory_order_relaxed);
+}
+
+// static
+size_t LatencyHistogram::BucketIndex(uint64_t value_us) {
+  value_us = std::min<uint64_t>(value_us, (1ULL << kMaxValueBits) - 1);
+  if (value_us < kSubBucketCount)
+    return static_cast<size_t>(value_us);
+
+  // Position of the highest set bit selects the power of two, the next
+  // kSubBucketBits bits select the sub bucket within it.
+  size_t msb = static_cast<size_t>(63 - __builtin_clzll(value_us));
+  size_t shift = msb - kSubBucketBits;
+  size_t sub_bucket =
+      static_cast<size_t>(value_us >> shift) & (kSubBucketCount - 1);
+  return kSubBucketCount + (shift * kSubBucketCount) + sub_bucket;
+}
+
+// static
+uint64_t LatencyHistogram::BucketUpperBound(size_t index) {
+  if (index < kSubBucketCount)
+    return index;
+
+  size_t shift = (index - kSubBucketCount) / kSubBucketCount;
+  uint64_t sub_bucket = (index - kSubBucketCount) % kSubBucketCount;
+  uint64_t lower = (kSubBucketCount + sub_bucket) << shift;
+  return lower + (1ULL << shift) - 1;
+}
+
+void QueueDepthCounter::Sample(size_t depth) {
+  uint32_t value = static_cast<uint32_t>(depth);
+  samples_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value, std::memory_order_relaxed);
+  if (value == 0)
+    empty_samples_.fetch_add(1, std::memory_order_relaxed);
+  current_.store(value, std::memory_order_relaxed);
+
+  uint32_t max = max_.load(std::memory_order_relaxed);
+  while ((value > max) &&
+         !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+  }
+}
+
+QueueDepthStats QueueDepthCounter::Snapshot() const {
+  QueueDepthStats stats;
+  stats.samples = samples_.load(std::memory_order_relaxed);
+  stats.empty_samples = empty_samples_.load(std::memory_order_relaxed);
+  stats.current = current_.load(std::memory_order_relaxed);
+  stats.max = max_.load(std::memory_order_relaxed);
+  if (stats.samples > 0)
+    stats.mean_x100 = (sum_.load(std::memory_order_relaxed) * 100) /
+                      stats.samples;
+  return stats;
+}
+
+void QueueDepthCounter::Reset() {
+  samples_.store(0, std::memory_order_relaxed);
+  empty_samples_.store(0, std::memory_order_relaxed);
+  sum_.store(0, std::memory_order_relaxed);
+  current_.store(0, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+}  //  namespace mcil
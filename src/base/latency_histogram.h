@@ -0,0 +1,83 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef SRC_BASE_LATENCY_HISTOGRAM_H_
+#define SRC_BASE_LATENCY_HISTOGRAM_H_
+
+#include <atomic>
+
+#include "codec_types.h"
+
+namespace mcil {
+
+// Histogram of durations in microseconds. Record() and Snapshot() only use
+// relaxed atomics, so the codec threads never block on a reader. Buckets are
+// exact below 8us and split every power of two in 8 above it, which keeps
+// the reported percentiles within 12.5% of the recorded values.
+class LatencyHistogram {
+ public:
+  LatencyHistogram();
+  ~LatencyHistogram() = default;
+
+  LatencyHistogram(const LatencyHistogram&) = delete;
+  LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+  void Record(uint64_t value_us);
+  void Record(MonotonicTime start, MonotonicTime end);
+  LatencyStats Snapshot() const;
+  void Reset();
+
+ private:
+  enum {
+    kSubBucketBits = 3,
+    kSubBucketCount = 1 << kSubBucketBits,
+    kMaxValueBits = 36,
+    kBucketCount =
+        kSubBucketCount + (kMaxValueBits - kSubBucketBits) * kSubBucketCount,
+  };
+
+  static size_t BucketIndex(uint64_t value_us);
+  static uint64_t BucketUpperBound(size_t index);
+
+  std::atomic<uint64_t> buckets_[kBucketCount];
+  std::atomic<uint64_t> max_us_{0};
+};
+
+// Running depth of a queue sampled at the points where the codec makes its
+// scheduling decisions. Same threading rules as LatencyHistogram.
+class QueueDepthCounter {
+ public:
+  QueueDepthCounter() = default;
+  ~QueueDepthCounter() = default;
+
+  QueueDepthCounter(const QueueDepthCounter&) = delete;
+  QueueDepthCounter& operator=(const QueueDepthCounter&) = delete;
+
+  void Sample(size_t depth);
+  QueueDepthStats Snapshot() const;
+  void Reset();
+
+ private:
+  std::atomic<uint64_t> samples_{0};
+  std::atomic<uint64_t> empty_samples_{0};
+  std::atomic<uint64_t> sum_{0};
+  std::atomic<uint32_t> current_{0};
+  std::atomic<uint32_t> max_{0};
+};
+
+}  // namespace mcil
+
+#endif  // SRC_BASE_LATENCY_HISTOGRAM_H_
@@ -16,6 +16,16 @@
 
 #include "log.h"
 
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 PmLogContext GetPmLogContext() {
   static PmLogContext mcil_log_context = nullptr;
 
@@ -31,3 +41,223 @@ std::string BaseFile(const char* file_path) {
   size_t last_slash_pos = filename.find_last_of("/");
   return filename.substr(last_slash_pos + 1);
 }
+
+namespace mcil {
+
+namespace {
+
+const size_t kMaxMessageSize = 1024;
+const size_t kAsyncSlotCount = 256;
+
+std::atomic<bool> async_logging{false};
+
+int32_t InitialLogLevel() {
+  const char* value = std::getenv("MCIL_LOG_LEVEL");
+  if (value == nullptr)
+    return MCIL_LOG_LEVEL_DEBUG;
+
+  if (strcmp(value, "none") == 0)
+    return MCIL_LOG_LEVEL_NONE;
+  if (strcmp(value, "error") == 0)
+    return MCIL_LOG_LEVEL_ERROR;
+  if (strcmp(value, "debug") == 0)
+    return MCIL_LOG_LEVEL_DEBUG;
+  if ((value[0] >= '0') && (value[0] <= '9'))
+    return atoi(value);
+  return MCIL_LOG_LEVEL_INFO;
+}
+
+void EmitMessage(int32_t level, const char* message) {
+  switch (level) {
+    case MCIL_LOG_LEVEL_ERROR:
+      PmLogError(GetPmLogContext(), "mcil", 0, "%s", message);
+      break;
+    case MCIL_LOG_LEVEL_INFO:
+      PmLogInfo(GetPmLogContext(), "mcil", 0, "%s", message);
+      break;
+    default:
+      PmLogDebug(GetPmLogContext(), "%s", message);
+      break;
+  }
+}
+
+// Fixed size ring of formatted messages drained by one thread. Messages
+// are dropped, and counted, when the ring is full rather than blocking the
+// codec threads.
+class AsyncLogSink {
+ public:
+  // Never destroyed, so logging from static destructors stays safe.
+  static AsyncLogSink* Get() {
+    static AsyncLogSink* sink = new AsyncLogSink();
+    return sink;
+  }
+
+  void Start() {
+    std::lock_guard<std::mutex> lock(lock_);
+    if (running_)
+      return;
+
+    running_ = true;
+    thread_ = std::thread(&AsyncLogSink::Run, this);
+  }
+
+  void Stop() {
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      if (!running_)
+        return;
+
+      running_ = false;
+    }
+
+    condition_.notify_one();
+    thread_.join();
+  }
+
+  void Push(int32_t level, const char* message) {
+    std::unique_lock<std::mutex> lock(lock_);
+    if (!running_) {
+      lock.unlock();
+      EmitMessage(level, message);
+      return;
+    }
+
+    if ((write_ - read_) == slots_.size()) {
+      dropped_++;
+      return;
+    }
+
+    Slot& slot = slots_[write_ % slots_.size()];
+    slot.level = level;
+    strncpy(slot.message, message, kMaxMessageSize - 1);
+    slot.message[kMaxMessageSize - 1] = '\0';
+    write_++;
+
+    bool wake_up = consumer_waiting_;
+    lock.unlock();
+    if (wake_up)
+      condition_.notify_one();
+  }
+
+ private:
+  struct Slot {
+    int32_t level;
+    char message[kMaxMessageSize];
+  };
+
+  AsyncLogSink() : slots_(kAsyncSlotCount) {}
+
+  void Run() {
+    while (true) {
+      size_t begin;
+      size_t end;
+      uint64_t dropped;
+      {
+        std::unique_lock<std::mutex> lock(lock_);
+        consumer_waiting_ = true;
+        condition_.wait(lock, [this] {
+          return (write_ != read_) || (dropped_ != 0) || !running_;
+        });
+        consumer_waiting_ = false;
+
+        if ((write_ == read_) && (dropped_ == 0) && !running_)
+          return;
+
+        begin = read_;
+        end = write_;
+        dropped = dropped_;
+        dropped_ = 0;
+      }
+
+      // Producers never touch slots in [read_, write_), so they can be
+      // emitted without the lock.
+      for (size_t i = begin; i < end; ++i) {
+        const Slot& slot = slots_[i % slots_.size()];
+        EmitMessage(slot.level, slot.message);
+      }
+
+      if (dropped != 0) {
+        char message[64];
+        snprintf(message, sizeof(message), "mcil: dropped %llu log messages",
+                 static_cast<unsigned long long>(dropped));
+        EmitMessage(MCIL_LOG_LEVEL_ERROR, message);
+      }
+
+      std::lock_guard<std::mutex> lock(lock_);
+      read_ = end;
+    }
+  }
+
+  std::mutex lock_;
+  std::condition_variable condition_;
+  std::vector<Slot> slots_;
+  size_t read_ = 0;
+  size_t write_ = 0;
+  uint64_t dropped_ = 0;
+  bool running_ = false;
+  bool consumer_waiting_ = false;
+  std::thread thread_;
+};
+
+void StopAsyncLoggingAtExit() {
+  SetAsyncLogging(false);
+}
+
+bool InitAsyncLoggingFromEnvironment() {
+  const char* value = std::getenv("MCIL_LOG_ASYNC");
+  if ((value != nullptr) && (strcmp(value, "1") == 0))
+    SetAsyncLogging(true);
+  return true;
+}
+
+}  // namespace
+
+std::atomic<int32_t> g_log_level{InitialLogLevel()};
+
+void SetLogLevel(int32_t level) {
+  g_log_level.store(level, std::memory_order_relaxed);
+}
+
+void SetAsyncLogging(bool async) {
+  static bool exit_handler_registered = false;
+
+  if (async) {
+    if (!exit_handler_registered) {
+      // Drain the ring before the process goes away.
+      atexit(StopAsyncLoggingAtExit);
+      exit_handler_registered = true;
+    }
+    AsyncLogSink::Get()->Start();
+    async_logging.store(true, std::memory_order_relaxed);
+  } else {
+    async_logging.store(false, std::memory_order_relaxed);
+    AsyncLogSink::Get()->Stop();
+  }
+}
+
+void LogMessage(int32_t level, const char* file, int32_t line,
+                const char* function, const char* format, ...) {
+  static const bool async_initialized = InitAsyncLoggingFromEnvironment();
+  (void)async_initialized;
+
+  char message[kMaxMessageSize];
+  int32_t prefix_size = snprintf(message, sizeof(message), "%s:[%d]:%s ",
+                                 file, line, function);
+  if (prefix_size < 0)
+    return;
+
+  if (static_cast<size_t>(prefix_size) < sizeof(message)) {
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message + prefix_size, sizeof(message) - prefix_size, format,
+              args);
+    va_end(args);
+  }
+
+  if (async_logging.load(std::memory_order_relaxed))
+    AsyncLogSink::Get()->Push(level, message);
+  else
+    EmitMessage(level, message);
+}
+
+}  // namespace mcil
@@ -18,9 +18,33 @@
 #ifndef SRC_BASE_LOG_H_
 #define SRC_BASE_LOG_H_
 
+#if defined(MCIL_WITHOUT_PMLOG)
+// Host builds without PmLogLib (e.g. benchmark). Logging is compiled out.
+typedef void* PmLogContext;
+typedef enum {
+  kPmLogLevel_Error = 3,
+  kPmLogLevel_Info = 6,
+  kPmLogLevel_Debug = 7,
+} PmLogLevel;
+inline int PmLogGetContext(const char* name, PmLogContext* context) {
+  *context = nullptr;
+  return 0;
+}
+inline bool PmLogIsEnabled(PmLogContext context, PmLogLevel level) {
+  return false;
+}
+#define PmLogCritical(...) ((void)0)
+#define PmLogWarning(...) ((void)0)
+#define PmLogInfo(...) ((void)0)
+#define PmLogDebug(...) ((void)0)
+#define PmLogError(...) ((void)0)
+#else
 #include <PmLogLib.h>
+#endif
 
+#include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <string>
 
 PmLogContext GetPmLogContext();
@@ -29,20 +53,103 @@ std::string BaseFile(const char* file_path);
 #define MCIL_LOG_CRITICAL(...) PmLogCritical(GetPmLogContext(), ##__VA_ARGS__)
 #define MCIL_LOG_WARNING(...)  PmLogWarning(GetPmLogContext(), ##__VA_ARGS__)
 
-#if 0
-#define MCIL_LOG_INFO(FORMAT__, ...) void(0)
-#define MCIL_LOG_DEBUG(FORMAT__, ...) void(0)
-#define MCIL_LOG_ERROR(FORMAT__, ...) void(0)
+#define MCIL_LOG_LEVEL_NONE  0
+#define MCIL_LOG_LEVEL_ERROR 1
+#define MCIL_LOG_LEVEL_INFO  2
+#define MCIL_LOG_LEVEL_DEBUG 3
+
+// Most verbose level compiled in. Anything above it costs nothing.
+#if !defined(MCIL_LOG_COMPILE_LEVEL)
+#define MCIL_LOG_COMPILE_LEVEL MCIL_LOG_LEVEL_DEBUG
+#endif
+
+namespace mcil {
+
+// Most verbose level emitted at runtime. Read from MCIL_LOG_LEVEL ("none",
+// "error", "info", "debug" or the level number), defaults to debug.
+extern std::atomic<int32_t> g_log_level;
+
+// Also checks the level of the PmLog context, so messages PmLog would drop
+// are not formatted either.
+inline bool IsLogLevelEnabled(int32_t level) {
+  if (level > g_log_level.load(std::memory_order_relaxed))
+    return false;
+
+  switch (level) {
+    case MCIL_LOG_LEVEL_ERROR:
+      return PmLogIsEnabled(GetPmLogContext(), kPmLogLevel_Error);
+    case MCIL_LOG_LEVEL_INFO:
+      return PmLogIsEnabled(GetPmLogContext(), kPmLogLevel_Info);
+    default:
+      return PmLogIsEnabled(GetPmLogContext(), kPmLogLevel_Debug);
+  }
+}
+
+void SetLogLevel(int32_t level);
+
+// When enabled, callers only format the message into a ring buffer and a
+// background thread hands it to PmLog. Also enabled with MCIL_LOG_ASYNC=1.
+void SetAsyncLogging(bool async);
+
+void LogMessage(int32_t level, const char* file, int32_t line,
+                const char* function, const char* format, ...)
+    __attribute__((format(printf, 5, 6)));
+
+constexpr const char* LogBaseName(const char* path,
+                                  const char* base = nullptr) {
+  return (*path == '\0') ? (base ? base : path)
+         : LogBaseName(path + 1, (*path == '/') ? (path + 1) : base);
+}
+
+}  // namespace mcil
+
+#if defined(__FILE_NAME__)
+#define MCIL_LOG_BASE_FILE __FILE_NAME__
+#else
+#define MCIL_LOG_BASE_FILE ::mcil::LogBaseName(__FILE__)
+#endif
+
+// The runtime level is checked before any argument is evaluated, and the
+// file basename is a compile time constant.
+#define MCIL_LOG_MESSAGE(LEVEL__, FORMAT__, ...) \
+  do { \
+    if (::mcil::IsLogLevelEnabled(LEVEL__)) { \
+      static constexpr const char* mcil_log_file = MCIL_LOG_BASE_FILE; \
+      ::mcil::LogMessage(LEVEL__, mcil_log_file, __LINE__, __func__, \
+                         FORMAT__, ##__VA_ARGS__); \
+    } \
+  } while (false)
+
+// Compiled out levels keep their arguments referenced and printf checked,
+// the call is never made.
+#define MCIL_LOG_DISABLED(LEVEL__, FORMAT__, ...) \
+  do { \
+    if (false) \
+      ::mcil::LogMessage(LEVEL__, "", 0, "", FORMAT__, ##__VA_ARGS__); \
+  } while (false)
+
+#if (MCIL_LOG_COMPILE_LEVEL >= MCIL_LOG_LEVEL_INFO)
+#define MCIL_LOG_INFO(FORMAT__, ...) \
+    MCIL_LOG_MESSAGE(MCIL_LOG_LEVEL_INFO, FORMAT__, ##__VA_ARGS__)
 #else
 #define MCIL_LOG_INFO(FORMAT__, ...) \
-    PmLogInfo(GetPmLogContext(), \
-    "mcil", 0, "%s:[%d]:%s " FORMAT__, BaseFile(__FILE__).c_str(), __LINE__, __func__,  ##__VA_ARGS__)
+    MCIL_LOG_DISABLED(MCIL_LOG_LEVEL_INFO, FORMAT__, ##__VA_ARGS__)
+#endif
+
+#if (MCIL_LOG_COMPILE_LEVEL >= MCIL_LOG_LEVEL_DEBUG)
+#define MCIL_LOG_DEBUG(FORMAT__, ...) \
+    MCIL_LOG_MESSAGE(MCIL_LOG_LEVEL_DEBUG, FORMAT__, ##__VA_ARGS__)
+#else
 #define MCIL_LOG_DEBUG(FORMAT__, ...) \
-    PmLogDebug(GetPmLogContext(), \
-    "%s:[%d]:%s " FORMAT__, BaseFile(__FILE__).c_str(), __LINE__, __FUNCTION__, ##__VA_ARGS__)
+    MCIL_LOG_DISABLED(MCIL_LOG_LEVEL_DEBUG, FORMAT__, ##__VA_ARGS__)
+#endif
+
+#if (MCIL_LOG_COMPILE_LEVEL >= MCIL_LOG_LEVEL_ERROR)
+#define MCIL_LOG_ERROR(FORMAT__, ...) \
+    MCIL_LOG_MESSAGE(MCIL_LOG_LEVEL_ERROR, FORMAT__, ##__VA_ARGS__)
+#else
 #define MCIL_LOG_ERROR(FORMAT__, ...) \
-    PmLogError(GetPmLogContext(), \
-    "mcil", 0, "%s:[%d]:%s " FORMAT__, BaseFile(__FILE__).c_str(), __LINE__, __FUNCTION__, ##__VA_ARGS__)
+    MCIL_LOG_DISABLED(MCIL_LOG_LEVEL_ERROR, FORMAT__, ##__VA_ARGS__)
 #endif
 
 #define MCIL_LOG_OBJ_SET(OBJ__) PmLogContext GetPmLogContext_##OBJ__()
@@ -59,8 +166,7 @@ std::string BaseFile(const char* file_path);
 /* Assert print */
 #define MCIL_ASSERT(cond) { \
     if (!(cond)) { \
-        MCIL_DEBUG_PRINT("%s:[%d]:%s ASSERT FAILED : %s", \
-                BaseFile(__FILE__).c_str(), __LINE__, __func__, #cond); \
+        MCIL_DEBUG_PRINT("ASSERT FAILED : %s", #cond); \
         assert(0); \
     } \
 }
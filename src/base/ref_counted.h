@@ -7,6 +7,7 @@
 
 #include <cstddef>
 
+#include <atomic>
 #include <iostream>
 #include <utility>
 
@@ -55,6 +56,49 @@ class RefCountedBase {
                 "ref_count_ must be an unsigned type.");
 };
 
+class RefCountedThreadSafeBase {
+ public:
+  bool HasOneRef() const {
+    return ref_count_.load(std::memory_order_acquire) == 1;
+  }
+  bool HasAtLeastOneRef() const {
+    return ref_count_.load(std::memory_order_acquire) >= 1;
+  }
+
+ protected:
+  explicit RefCountedThreadSafeBase(StartRefCountFromZeroTag) {
+  }
+
+  explicit RefCountedThreadSafeBase(StartRefCountFromOneTag)
+      : ref_count_(1) {
+  }
+
+  ~RefCountedThreadSafeBase() {
+  }
+
+  // A new reference is always made from an existing one, so the increment
+  // needs no ordering.
+  void AddRef() const {
+    ref_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Returns true if the object should self-delete. The acq_rel decrement
+  // makes every access through the other references visible to the thread
+  // running the destructor.
+  bool Release() const {
+    return ref_count_.fetch_sub(1, std::memory_order_acq_rel) == 1;
+  }
+
+ private:
+  template <typename U>
+  friend scoped_refptr<U> AdoptRef(U*);
+
+  void Adopted() const {
+  }
+
+  mutable std::atomic<uint32_t> ref_count_{0};
+};
+
 }  // namespace subtle
 
 template <class T, typename Traits> class RefCounted;
@@ -97,6 +141,49 @@ class RefCounted : public subtle::RefCountedBase {
   }
 };
 
+// Same as RefCounted, but the reference count is atomic, so references can
+// be taken and dropped on any thread, e.g. buffers handed from the codec
+// thread to the client's render thread. Only the count is thread safe, not
+// the object itself.
+template <class T, typename Traits> class RefCountedThreadSafe;
+
+template <typename T>
+struct DefaultRefCountedThreadSafeTraits {
+  static void Destruct(const T* x) {
+    RefCountedThreadSafe<T, DefaultRefCountedThreadSafeTraits>::DeleteInternal(
+        x);
+  }
+};
+
+template <class T, typename Traits = DefaultRefCountedThreadSafeTraits<T> >
+class RefCountedThreadSafe : public subtle::RefCountedThreadSafeBase {
+ public:
+  static constexpr subtle::StartRefCountFromZeroTag kRefCountPreference =
+      subtle::kStartRefCountFromZeroTag;
+
+  RefCountedThreadSafe()
+      : subtle::RefCountedThreadSafeBase(T::kRefCountPreference) {}
+
+  void AddRef() const {
+    subtle::RefCountedThreadSafeBase::AddRef();
+  }
+
+  void Release() const {
+    if (subtle::RefCountedThreadSafeBase::Release())
+      Traits::Destruct(static_cast<const T*>(this));
+  }
+
+ protected:
+  ~RefCountedThreadSafe() = default;
+
+ private:
+  friend struct DefaultRefCountedThreadSafeTraits<T>;
+  template <typename U>
+  static void DeleteInternal(const U* x) {
+    delete x;
+  }
+};
+
 }  // namespace mcil
 
 #endif  // BASE_MCIL_REF_COUNTED_H_
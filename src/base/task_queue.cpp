@@ -0,0 +1,146 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "task_queue.h"
+
+#include "base/futex.h"
+
+namespace mcil {
+
+namespace {
+
+static_assert((TaskQueue::kCapacity & (TaskQueue::kCapacity - 1)) == 0,
+              "kCapacity must be a power of two");
+
+}  // namespace
+
+TaskQueue::TaskQueue()
+  : cells_(new Cell[kCapacity]) {
+  for (size_t i = 0; i < kCapacity; ++i)
+    cells_[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+TaskQueue::~TaskQueue() = default;
+
+void TaskQueue::Push(Task task) {
+  bool pushed = false;
+  if (overflow_count_.load(std::memory_order_acquire) == 0)
+    pushed = TryPushToRing(&task);
+
+  if (!pushed) {
+    std::lock_guard<std::mutex> lock(overflow_lock_);
+    overflow_.push_back(std::move(task));
+    overflow_count_.fetch_add(1, std::memory_order_release);
+  }
+
+  WakeUpConsumer();
+}
+
+bool TaskQueue::WaitAndPop(Task* task) {
+  while (true) {
+    if (TryPop(task))
+      return true;
+
+    if (closed_.load(std::memory_order_acquire))
+      return TryPop(task);
+
+    // Pairs with the fence in WakeUpConsumer(): either the producer sees
+    // |sleeping_| set, or the pending task is seen here.
+    sleeping_.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!HasPendingTasks() && !closed_.load(std::memory_order_relaxed))
+      FutexWait(&sleeping_, 1);
+    sleeping_.store(0, std::memory_order_relaxed);
+  }
+}
+
+void TaskQueue::Close() {
+  closed_.store(true, std::memory_order_release);
+  WakeUpConsumer();
+}
+
+void TaskQueue::Open() {
+  closed_.store(false, std::memory_order_release);
+}
+
+bool TaskQueue::TryPushToRing(Task* task) {
+  size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+  Cell* cell;
+  while (true) {
+    cell = &cells_[pos & (kCapacity - 1)];
+    size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    intptr_t diff = static_cast<intptr_t>(sequence) -
+                    static_cast<intptr_t>(pos);
+    if (diff == 0) {
+      if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed))
+        break;
+    } else if (diff < 0) {
+      // Full, the consumer has not released this cell yet.
+      return false;
+    } else {
+      pos = enqueue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+
+  cell->task = std::move(*task);
+  cell->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+bool TaskQueue::TryPop(Task* task) {
+  Cell* cell = &cells_[dequeue_pos_ & (kCapacity - 1)];
+  if (cell->sequence.load(std::memory_order_acquire) == dequeue_pos_ + 1) {
+    *task = std::move(cell->task);
+    cell->sequence.store(dequeue_pos_ + kCapacity, std::memory_order_release);
+    dequeue_pos_++;
+    return true;
+  }
+
+  // A claimed but not yet published cell holds an older task than anything
+  // in |overflow_|, so wait for the ring to be really empty.
+  if (!CanPopOverflow())
+    return false;
+
+  std::lock_guard<std::mutex> lock(overflow_lock_);
+  if (overflow_.empty())
+    return false;
+
+  *task = std::move(overflow_.front());
+  overflow_.pop_front();
+  overflow_count_.fetch_sub(1, std::memory_order_release);
+  return true;
+}
+
+bool TaskQueue::HasPendingTasks() const {
+  const Cell* cell = &cells_[dequeue_pos_ & (kCapacity - 1)];
+  return (cell->sequence.load(std::memory_order_acquire) ==
+          dequeue_pos_ + 1) || CanPopOverflow();
+}
+
+bool TaskQueue::CanPopOverflow() const {
+  return (overflow_count_.load(std::memory_order_acquire) != 0) &&
+         (enqueue_pos_.load(std::memory_order_acquire) == dequeue_pos_);
+}
+
+void TaskQueue::WakeUpConsumer() {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if ((sleeping_.load(std::memory_order_relaxed) == 1) &&
+      (sleeping_.exchange(0, std::memory_order_relaxed) == 1))
+    FutexWake(&sleeping_);
+}
+
+}  //  namespace mcil
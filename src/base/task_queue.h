@@ -0,0 +1,206 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef SRC_BASE_TASK_QUEUE_H_
+#define SRC_BASE_TASK_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace mcil {
+
+// Move-only callable. Callables up to kInlineSize bytes, e.g. a std::bind()
+// of a member function with a couple of arguments, are stored inline, so
+// creating and running a Task does not allocate.
+class Task {
+ public:
+  enum { kInlineSize = 48 };
+
+  Task() = default;
+
+  template <typename F,
+            typename = typename std::enable_if<!std::is_same<
+                typename std::decay<F>::type, Task>::value>::type>
+  Task(F&& callable) {
+    Init<typename std::decay<F>::type>(std::forward<F>(callable));
+  }
+
+  Task(Task&& other) noexcept { MoveFrom(&other); }
+
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      MoveFrom(&other);
+    }
+    return *this;
+  }
+
+  ~Task() { Reset(); }
+
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+
+  explicit operator bool() const { return ops_ != nullptr; }
+  void operator()() { ops_->invoke(&storage_); }
+
+  void Reset() {
+    if (ops_ != nullptr) {
+      ops_->destroy(&storage_);
+      ops_ = nullptr;
+    }
+  }
+
+ private:
+  using Storage =
+      typename std::aligned_storage<kInlineSize, alignof(max_align_t)>::type;
+
+  struct Ops {
+    void (*invoke)(Storage* storage);
+    // Move constructs into |to| and destroys |from|.
+    void (*relocate)(Storage* to, Storage* from);
+    void (*destroy)(Storage* storage);
+  };
+
+  template <typename F>
+  struct InlineOps {
+    static F* Get(Storage* storage) { return reinterpret_cast<F*>(storage); }
+    static void Invoke(Storage* storage) { (*Get(storage))(); }
+    static void Relocate(Storage* to, Storage* from) {
+      new (to) F(std::move(*Get(from)));
+      Get(from)->~F();
+    }
+    static void Destroy(Storage* storage) { Get(storage)->~F(); }
+    static constexpr Ops kOps = {Invoke, Relocate, Destroy};
+  };
+
+  template <typename F>
+  struct HeapOps {
+    static F*& Get(Storage* storage) {
+      return *reinterpret_cast<F**>(storage);
+    }
+    static void Invoke(Storage* storage) { (*Get(storage))(); }
+    static void Relocate(Storage* to, Storage* from) {
+      new (to) F*(Get(from));
+    }
+    static void Destroy(Storage* storage) { delete Get(storage); }
+    static constexpr Ops kOps = {Invoke, Relocate, Destroy};
+  };
+
+  template <typename F>
+  using FitsInline = std::integral_constant<bool,
+      (sizeof(F) <= kInlineSize) && (alignof(F) <= alignof(max_align_t)) &&
+      std::is_nothrow_move_constructible<F>::value>;
+
+  template <typename F, typename Arg>
+  void Init(Arg&& callable) {
+    Init<F>(std::forward<Arg>(callable), FitsInline<F>());
+  }
+
+  template <typename F, typename Arg>
+  void Init(Arg&& callable, std::true_type /* fits inline */) {
+    new (&storage_) F(std::forward<Arg>(callable));
+    ops_ = &InlineOps<F>::kOps;
+  }
+
+  template <typename F, typename Arg>
+  void Init(Arg&& callable, std::false_type /* fits inline */) {
+    new (&storage_) F*(new F(std::forward<Arg>(callable)));
+    ops_ = &HeapOps<F>::kOps;
+  }
+
+  void MoveFrom(Task* other) {
+    if (other->ops_ != nullptr) {
+      other->ops_->relocate(&storage_, &other->storage_);
+      ops_ = other->ops_;
+      other->ops_ = nullptr;
+    }
+  }
+
+  Storage storage_;
+  const Ops* ops_ = nullptr;
+};
+
+template <typename F>
+constexpr Task::Ops Task::InlineOps<F>::kOps;
+
+template <typename F>
+constexpr Task::Ops Task::HeapOps<F>::kOps;
+
+// Multi producer, single consumer FIFO of Tasks. Push() never blocks: tasks
+// go to a fixed lock-free ring, and only spill to a mutex guarded list when
+// the ring is full. The consumer sleeps on a futex, and producers only make
+// the wake up syscall when it is actually asleep.
+class TaskQueue {
+ public:
+  enum { kCapacity = 256 };
+
+  TaskQueue();
+  ~TaskQueue();
+
+  TaskQueue(const TaskQueue&) = delete;
+  TaskQueue& operator=(const TaskQueue&) = delete;
+
+  // Can be called from any thread.
+  void Push(Task task);
+
+  // Consumer thread only. Blocks until a task is available and returns
+  // true, or returns false once the queue is closed and empty.
+  bool WaitAndPop(Task* task);
+
+  // Makes WaitAndPop() return false after the remaining tasks are popped.
+  void Close();
+  // Reopens the queue after Close(), before a new consumer starts.
+  void Open();
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    Task task;
+  };
+
+  bool TryPushToRing(Task* task);
+  bool TryPop(Task* task);
+  bool HasPendingTasks() const;
+  bool CanPopOverflow() const;
+  void WakeUpConsumer();
+
+  std::unique_ptr<Cell[]> cells_;
+  std::atomic<size_t> enqueue_pos_{0};
+  // Keeps the producer and consumer positions on separate cache lines.
+  // alignas() would make the owning classes over-aligned for C++14 new.
+  char padding_[64];
+  size_t dequeue_pos_ = 0;
+
+  // Tasks that did not fit in the ring. While any are pending, new tasks
+  // go here too, so that tasks of one producer stay in order.
+  std::mutex overflow_lock_;
+  std::deque<Task> overflow_;
+  std::atomic<size_t> overflow_count_{0};
+
+  // 1 while the consumer is, or is about to be, asleep on the futex.
+  std::atomic<int32_t> sleeping_{0};
+  std::atomic<bool> closed_{false};
+};
+
+}  // namespace mcil
+
+#endif  // SRC_BASE_TASK_QUEUE_H_
@@ -16,6 +16,7 @@
 
 #include "log.h"
 #include "thread.h"
+#include "trace_event.h"
 
 namespace mcil {
 
@@ -30,15 +31,10 @@ Thread::~Thread() noexcept(false) {
     Stop();
 }
 
-void Thread::PostTask(std::function<void()> task) {
+void Thread::PostTask(Task task) {
   MCIL_DEBUG_PRINT(": %s", thread_name_.c_str());
 
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    task_queue_.push_back(task);
-  }
-
-  condition_.notify_all();
+  task_queue_.Push(std::move(task));
 }
 
 void Thread::Start() {
@@ -52,6 +48,7 @@ void Thread::Start() {
     is_thread_running_ = true;
   }
 
+  task_queue_.Open();
   thread_object_ = std::thread(&Thread::RunInternal, this);
 }
 
@@ -66,32 +63,21 @@ void Thread::Stop() {
     is_thread_running_ = false;
   }
 
-  condition_.notify_all();
+  task_queue_.Close();
   thread_object_.join();
 }
 
 void Thread::RunInternal() {
-  while (true) {
-    decltype(task_queue_) local_queue;
-    {
-      std::unique_lock<std::mutex> lock(mutex_);
-      condition_.wait(lock, [&] {
-        return !task_queue_.empty() || !is_thread_running_;
-      });
-
-      if (!is_thread_running_) {
-        for (auto& task : task_queue_)
-          task();
+  MCIL_TRACE_SET_THREAD_NAME(thread_name_);
 
-        task_queue_.clear();
-        return;
-      }
-
-      std::swap(task_queue_, local_queue);
-    }
-
-    for (auto& task : local_queue)
+  // Tasks posted before Stop() still run before the thread exits.
+  Task task;
+  while (task_queue_.WaitAndPop(&task)) {
+    {
+      MCIL_TRACE_EVENT("Thread::RunTask");
       task();
+    }
+    task.Reset();
   }
 }
 
@@ -17,12 +17,13 @@
 #ifndef SRC_BASE_MCIL_THREAD_H_
 #define SRC_BASE_MCIL_THREAD_H_
 
-#include <condition_variable>
-#include <list>
 #include <functional>
+#include <mutex>
 #include <string>
 #include <thread>
 
+#include "task_queue.h"
+
 namespace mcil {
 
 class Thread {
@@ -35,13 +36,14 @@ class Thread {
   void Start();
   void Stop();
 
-  void PostTask(std::function<void()>);
+  // Lock-free and, for small callables, allocation free. Can be called
+  // from any thread, including this one.
+  void PostTask(Task task);
 
  private:
   void RunInternal();
 
-  std::condition_variable condition_;
-  std::list<std::function<void()>> task_queue_;
+  TaskQueue task_queue_;
   std::mutex mutex_;
   std::thread thread_object_;
   bool is_thread_running_ = false;
@@ -0,0 +1,279 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "trace_event.h"
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <mutex>
+#include <vector>
+
+#include "log.h"
+
+namespace mcil {
+
+namespace {
+
+// Buffers of exited threads are kept for the dump, up to this many.
+const size_t kMaxRetiredBuffers = 16;
+
+struct TraceEvent {
+  const char* name;
+  const char* arg_name;
+  int64_t arg_value;
+  int64_t timestamp_ns;
+  int64_t duration_ns;
+  char phase;
+};
+
+struct ThreadTraceBuffer {
+  std::mutex lock;
+  std::vector<TraceEvent> events;
+  size_t next = 0;
+  int32_t tid = 0;
+  std::string name;
+  bool retired = false;
+};
+
+std::mutex& RegistryLock() {
+  static std::mutex lock;
+  return lock;
+}
+
+std::list<std::shared_ptr<ThreadTraceBuffer>>& Registry() {
+  static std::list<std::shared_ptr<ThreadTraceBuffer>> buffers;
+  return buffers;
+}
+
+std::string& TraceFilePath() {
+  static std::string path;
+  return path;
+}
+
+void WriteTraceFileAtExit() {
+  TraceLog::WriteJson(TraceFilePath());
+}
+
+bool InitFromEnvironment() {
+  const char* path = std::getenv("MCIL_TRACE_FILE");
+  if ((path == nullptr) || (path[0] == '\0'))
+    return false;
+
+  // Construct everything the exit handler touches before registering it,
+  // so they are destroyed after it runs.
+  RegistryLock();
+  Registry();
+  TraceFilePath() = path;
+  atexit(WriteTraceFileAtExit);
+  return true;
+}
+
+std::atomic<bool>& EnabledFlag() {
+  static std::atomic<bool> enabled{InitFromEnvironment()};
+  return enabled;
+}
+
+class ThreadBufferHolder {
+ public:
+  ThreadBufferHolder() = default;
+
+  ~ThreadBufferHolder() {
+    if (!buffer_)
+      return;
+
+    std::lock_guard<std::mutex> lock(RegistryLock());
+    buffer_->retired = true;
+
+    // Buffers are in creation order, drop the oldest retired ones.
+    auto& buffers = Registry();
+    size_t retired = 0;
+    for (const auto& buffer : buffers)
+      retired += buffer->retired ? 1 : 0;
+    for (auto it = buffers.begin();
+         (it != buffers.end()) && (retired > kMaxRetiredBuffers);) {
+      if ((*it)->retired) {
+        it = buffers.erase(it);
+        retired--;
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  ThreadTraceBuffer* Get() {
+    if (buffer_)
+      return buffer_.get();
+
+    buffer_ = std::make_shared<ThreadTraceBuffer>();
+    buffer_->events.resize(TraceLog::kEventsPerThread);
+    buffer_->tid = static_cast<int32_t>(syscall(SYS_gettid));
+
+    std::lock_guard<std::mutex> lock(RegistryLock());
+    Registry().push_back(buffer_);
+    return buffer_.get();
+  }
+
+ private:
+  std::shared_ptr<ThreadTraceBuffer> buffer_;
+};
+
+thread_local ThreadBufferHolder thread_buffer;
+
+int64_t ToNanoseconds(MonotonicTime time) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      time.time_since_epoch()).count();
+}
+
+void AddEvent(const TraceEvent& event) {
+  ThreadTraceBuffer* buffer = thread_buffer.Get();
+
+  std::lock_guard<std::mutex> lock(buffer->lock);
+  buffer->events[buffer->next % buffer->events.size()] = event;
+  buffer->next++;
+}
+
+std::string EscapeJson(const std::string& value) {
+  std::string escaped;
+  for (char c : value) {
+    if ((c == '"') || (c == '\\'))
+      escaped.push_back('\\');
+    if (static_cast<unsigned char>(c) >= 0x20)
+      escaped.push_back(c);
+  }
+  return escaped;
+}
+
+void WriteEvent(FILE* file, const TraceEvent& event, int32_t pid,
+                int32_t tid) {
+  fprintf(file, "{\"name\":\"%s\",\"cat\":\"mcil\",\"ph\":\"%c\","
+          "\"ts\":%.3f,", event.name, event.phase,
+          event.timestamp_ns / 1000.0);
+  if (event.phase == 'X')
+    fprintf(file, "\"dur\":%.3f,", event.duration_ns / 1000.0);
+  else
+    fprintf(file, "\"s\":\"t\",");
+  fprintf(file, "\"pid\":%d,\"tid\":%d,\"args\":{", pid, tid);
+  if (event.arg_name != nullptr) {
+    fprintf(file, "\"%s\":%lld", event.arg_name,
+            static_cast<long long>(event.arg_value));
+  }
+  fprintf(file, "}}");
+}
+
+}  // namespace
+
+// static
+bool TraceLog::IsEnabled() {
+  return EnabledFlag().load(std::memory_order_relaxed);
+}
+
+// static
+void TraceLog::SetEnabled(bool enabled) {
+  EnabledFlag().store(enabled, std::memory_order_relaxed);
+}
+
+// static
+void TraceLog::SetThreadName(const std::string& name) {
+  if (!IsEnabled())
+    return;
+
+  ThreadTraceBuffer* buffer = thread_buffer.Get();
+  std::lock_guard<std::mutex> lock(buffer->lock);
+  buffer->name = name;
+}
+
+// static
+void TraceLog::AddCompleteEvent(const char* name, MonotonicTime start,
+                                MonotonicTime end, const char* arg_name,
+                                int64_t arg_value) {
+  TraceEvent event;
+  event.name = name;
+  event.arg_name = arg_name;
+  event.arg_value = arg_value;
+  event.timestamp_ns = ToNanoseconds(start);
+  event.duration_ns = ToNanoseconds(end) - event.timestamp_ns;
+  event.phase = 'X';
+  AddEvent(event);
+}
+
+// static
+void TraceLog::AddInstantEvent(const char* name, const char* arg_name,
+                               int64_t arg_value) {
+  if (!IsEnabled())
+    return;
+
+  TraceEvent event;
+  event.name = name;
+  event.arg_name = arg_name;
+  event.arg_value = arg_value;
+  event.timestamp_ns = ToNanoseconds(std::chrono::steady_clock::now());
+  event.duration_ns = 0;
+  event.phase = 'i';
+  AddEvent(event);
+}
+
+// static
+bool TraceLog::WriteJson(const std::string& path) {
+  FILE* file = fopen(path.c_str(), "w");
+  if (file == nullptr) {
+    MCIL_ERROR_PRINT(": Failed to open trace file %s", path.c_str());
+    return false;
+  }
+
+  const int32_t pid = static_cast<int32_t>(getpid());
+  bool first = true;
+  fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+  std::lock_guard<std::mutex> registry_lock(RegistryLock());
+  for (const auto& buffer : Registry()) {
+    std::lock_guard<std::mutex> lock(buffer->lock);
+    if (!buffer->name.empty()) {
+      fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,"
+              "\"tid\":%d,\"args\":{\"name\":\"%s\"}}", first ? "" : ",\n",
+              pid, buffer->tid, EscapeJson(buffer->name).c_str());
+      first = false;
+    }
+
+    const size_t capacity = buffer->events.size();
+    const size_t count = std::min(buffer->next, capacity);
+    for (size_t i = buffer->next - count; i < buffer->next; ++i) {
+      fprintf(file, "%s", first ? "" : ",\n");
+      WriteEvent(file, buffer->events[i % capacity], pid, buffer->tid);
+      first = false;
+    }
+  }
+
+  fprintf(file, "\n]}\n");
+  fclose(file);
+  return true;
+}
+
+// static
+void TraceLog::Clear() {
+  std::lock_guard<std::mutex> registry_lock(RegistryLock());
+  for (const auto& buffer : Registry()) {
+    std::lock_guard<std::mutex> lock(buffer->lock);
+    buffer->next = 0;
+  }
+}
+
+}  //  namespace mcil
@@ -0,0 +1,113 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef SRC_BASE_TRACE_EVENT_H_
+#define SRC_BASE_TRACE_EVENT_H_
+
+#include <string>
+
+#include "codec_types.h"
+
+// Pipeline tracing, compiled in with ENABLE_TRACING. Recording starts when
+// MCIL_TRACE_FILE is set in the environment, and the events are written to
+// that path in Chrome trace JSON format at process exit. The file can be
+// loaded in chrome://tracing or ui.perfetto.dev.
+//
+// Event and argument names must be string literals, only the pointers are
+// recorded.
+#if defined(ENABLE_TRACING)
+
+#define MCIL_TRACE_CONCAT_INTERNAL(a, b) a##b
+#define MCIL_TRACE_CONCAT(a, b) MCIL_TRACE_CONCAT_INTERNAL(a, b)
+
+#define MCIL_TRACE_EVENT(name) \
+  ::mcil::ScopedTraceEvent MCIL_TRACE_CONCAT(trace_event_, __LINE__)(name)
+#define MCIL_TRACE_EVENT1(name, arg_name, arg_value) \
+  ::mcil::ScopedTraceEvent MCIL_TRACE_CONCAT(trace_event_, __LINE__)( \
+      name, arg_name, static_cast<int64_t>(arg_value))
+#define MCIL_TRACE_INSTANT(name) \
+  ::mcil::TraceLog::AddInstantEvent(name, nullptr, 0)
+#define MCIL_TRACE_INSTANT1(name, arg_name, arg_value) \
+  ::mcil::TraceLog::AddInstantEvent(name, arg_name, \
+                                    static_cast<int64_t>(arg_value))
+#define MCIL_TRACE_SET_THREAD_NAME(name) \
+  ::mcil::TraceLog::SetThreadName(name)
+
+#else
+
+#define MCIL_TRACE_EVENT(name) ((void)0)
+#define MCIL_TRACE_EVENT1(name, arg_name, arg_value) ((void)0)
+#define MCIL_TRACE_INSTANT(name) ((void)0)
+#define MCIL_TRACE_INSTANT1(name, arg_name, arg_value) ((void)0)
+#define MCIL_TRACE_SET_THREAD_NAME(name) ((void)0)
+
+#endif
+
+namespace mcil {
+
+// Events are kept in a fixed size ring per thread, so a long session only
+// keeps the most recent kEventsPerThread events of every thread.
+class TraceLog {
+ public:
+  enum { kEventsPerThread = 16384 };
+
+  static bool IsEnabled();
+  static void SetEnabled(bool enabled);
+
+  static void SetThreadName(const std::string& name);
+  static void AddCompleteEvent(const char* name, MonotonicTime start,
+                               MonotonicTime end, const char* arg_name,
+                               int64_t arg_value);
+  static void AddInstantEvent(const char* name, const char* arg_name,
+                              int64_t arg_value);
+
+  // Writes the buffered events of all threads to |path|.
+  static bool WriteJson(const std::string& path);
+  static void Clear();
+};
+
+class ScopedTraceEvent {
+ public:
+  explicit ScopedTraceEvent(const char* name, const char* arg_name = nullptr,
+                            int64_t arg_value = 0)
+      : name_(TraceLog::IsEnabled() ? name : nullptr),
+        arg_name_(arg_name),
+        arg_value_(arg_value) {
+    if (name_ != nullptr)
+      start_ = std::chrono::steady_clock::now();
+  }
+
+  ~ScopedTraceEvent() {
+    if (name_ != nullptr) {
+      TraceLog::AddCompleteEvent(name_, start_,
+                                 std::chrono::steady_clock::now(),
+                                 arg_name_, arg_value_);
+    }
+  }
+
+  ScopedTraceEvent(const ScopedTraceEvent&) = delete;
+  ScopedTraceEvent& operator=(const ScopedTraceEvent&) = delete;
+
+ private:
+  const char* name_;
+  const char* arg_name_;
+  int64_t arg_value_;
+  MonotonicTime start_;
+};
+
+}  // namespace mcil
+
+#endif  // SRC_BASE_TRACE_EVENT_H_
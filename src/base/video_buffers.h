@@ -10,7 +10,7 @@
 
 namespace mcil {
 
-class ReadableBuffer : public RefCounted<ReadableBuffer> {
+class ReadableBuffer : public RefCountedThreadSafe<ReadableBuffer> {
  public:
   ReadableBuffer() = default;
   virtual ~ReadableBuffer() = default;
@@ -28,7 +28,7 @@ class ReadableBuffer : public RefCounted<ReadableBuffer> {
   virtual uint32_t GetFlags() const { return 0; }
 
  private:
-  friend class RefCounted<ReadableBuffer>;
+  friend class RefCountedThreadSafe<ReadableBuffer>;
 };
 
 using ReadableBufferRef = scoped_refptr<ReadableBuffer>;
@@ -44,6 +44,18 @@ class VideoDecoder : public RefCounted<VideoDecoder> {
 
   virtual bool DecodeBuffer(const void* buffer, size_t buffer_size,
                             const int32_t buffer_id, int64_t buffer_pts) = 0;
+  // Write in place alternative to DecodeBuffer(). AcquireInputBuffer()
+  // returns at least |min_size| bytes of free input buffer memory for the
+  // client to write an access unit into, or nullptr when stalled for input
+  // buffers. CommitInputBuffer() then takes the first |size| bytes written
+  // there, as DecodeBuffer() takes a copy of its buffer. No other input
+  // calls may be made in between. With VideoDecoderClient::InputRing() the
+  // memory handed out is the ring itself, so this is the copy free path.
+  virtual void* AcquireInputBuffer(size_t min_size) { return nullptr; }
+  virtual bool CommitInputBuffer(size_t size, const int32_t buffer_id,
+                                 int64_t buffer_pts) {
+    return false;
+  }
   virtual bool FlushInputBuffers() = 0;
   virtual bool DidFlushBuffersDone() = 0;
 
@@ -59,10 +71,21 @@ class VideoDecoder : public RefCounted<VideoDecoder> {
   virtual bool AllocateOutputBuffers(
       uint32_t buffer_count,
       std::vector<WritableBufferRef*> & output_buffers) = 0;
+  // OUTPUT_IMPORT only. Hands in the dmabufs the output buffer at index
+  // |pic_buffer_id| decodes into, usually from CreateOutputBuffers() right
+  // after AllocateOutputBuffers(), one fd per plane of the capture format.
+  // The fds stay owned by the client and must stay open until
+  // DestroyOutputBuffers(). A buffer is only queued to the device once
+  // imported.
+  virtual bool ImportBufferForPicture(int32_t pic_buffer_id,
+                                      scoped_refptr<VideoFrame> frame) {
+    return false;
+  }
   virtual bool CanCreateEGLImageFrom(VideoPixelFormat pixel_format) = 0;
 
   virtual void RunDecoderPostTask(PostTaskType task, bool value) = 0;
   virtual void OnEGLImagesCreationCompleted() = 0;
+  virtual bool GetStats(DecoderStats* stats) { return false; }
 
   #if defined (ENABLE_REACQUIRE)
   virtual void SetResolutionChangeCb(ResolutionChangeCb cb) {}
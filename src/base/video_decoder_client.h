@@ -17,11 +17,22 @@
 #ifndef SRC_BASE_VIDEO_DECODER_CLIENT_H_
 #define SRC_BASE_VIDEO_DECODER_CLIENT_H_
 
+#include <mutex>
+#include <vector>
+
 #include "decoder_types.h"
 #include "video_buffers.h"
 
 namespace mcil {
 
+// One decoded buffer of a batched delivery, with the arguments
+// SendBufferToClient() would have been called with.
+struct DecodedBuffer {
+  size_t buffer_index;
+  int32_t buffer_id;
+  ReadableBufferRef buffer;
+};
+
 // Video decoder client interface. This interface is implemented
 // by the components that uses the VideoDecoderAPI.
 class VideoDecoderClient {
@@ -42,6 +53,28 @@ class VideoDecoderClient {
                                       const Size& visible_size) = 0;
   virtual void SendBufferToClient(
       size_t buffer_index, int32_t buffer_id, ReadableBufferRef buffer) = 0;
+  // Batched delivery. When UseBatchedOutput() returns true, the buffers
+  // decoded in one device wake up are handed over in a single
+  // SendBuffersToClient() call, in decode order, instead of one
+  // SendBufferToClient() call each.
+  virtual bool UseBatchedOutput() { return false; }
+  virtual void SendBuffersToClient(
+      const std::vector<DecodedBuffer>& buffers) {}
+  // Direct dispatch, for clients without thread affinity. When a lock is
+  // returned, the decoder calls RunDecodeBufferTask() itself on its device
+  // poll thread, holding that lock, instead of NotifyDecodeBufferTask().
+  // The other callbacks then come from that thread too, or from within the
+  // client's own calls. The client must hold the lock around every call it
+  // makes into the decoder. NotifyDecodeBufferTask() is still used when the
+  // lock is taken at that moment, and with the shared device poller
+  // (V4L2_SHARED_POLL=1).
+  virtual std::recursive_mutex* DirectDispatchLock() { return nullptr; }
+  // Input ring, read once at initialization. When page aligned memory is
+  // returned, with its size in |size|, input access units are queued from
+  // it instead of from driver allocated input buffers. It must stay valid
+  // until the decoder is destroyed. DecodeBuffer() still copies into the
+  // ring, only AcquireInputBuffer() lets the client write straight into it.
+  virtual uint8_t* InputRing(size_t* size) { return nullptr; }
   virtual void CheckGLFences() = 0;
 
   virtual void NotifyDecoderError(DecoderError error) = 0;
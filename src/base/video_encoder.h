@@ -53,6 +53,7 @@ class VideoEncoder : public RefCounted<VideoEncoder> {
                             const uint8_t* vBuf, size_t vSize,
                             uint64_t bufferTimestamp,
                             bool requestKeyFrame) { return true; }
+  virtual bool GetStats(EncoderStats* stats) { return false; }
 
  protected:
   friend class RefCounted<VideoEncoder>;
@@ -17,6 +17,8 @@
 #ifndef SRC_BASE_VIDEO_ENCODER_CLIENT_H_
 #define SRC_BASE_VIDEO_ENCODER_CLIENT_H_
 
+#include <mutex>
+
 #include "encoder_types.h"
 
 namespace mcil {
@@ -37,6 +39,27 @@ class VideoEncoderClient {
                                     uint64_t timestamp,
                                     bool is_key_frame) = 0;
   virtual void PumpBitstreamBuffers() = 0;
+  // Batched delivery. When UseBatchedOutput() returns true, the bitstream
+  // buffers dequeued in one device wake up are handed over in a single
+  // BitstreamBuffersReady() call instead of one BitstreamBufferReady() call
+  // each.
+  virtual bool UseBatchedOutput() { return false; }
+  virtual void BitstreamBuffersReady(
+      const std::vector<ReadableBufferRef>& buffers) {}
+  // Direct dispatch, for clients without thread affinity. When a lock is
+  // returned, the encoder calls RunEncodeBufferTask() itself on its device
+  // poll thread, holding that lock, instead of NotifyEncodeBufferTask().
+  // The other callbacks then come from that thread too, or from within the
+  // client's own calls. The client must hold the lock around every call it
+  // makes into the encoder. NotifyEncodeBufferTask() is still used when the
+  // lock is taken at that moment, and with the shared device poller
+  // (V4L2_SHARED_POLL=1).
+  virtual std::recursive_mutex* DirectDispatchLock() { return nullptr; }
+  // Zero copy input. When true, every frame passed to EncodeFrame() must
+  // carry one dmabuf fd per plane of the device input format, and the
+  // encoder queues those instead of copying |data|. The fds must stay open
+  // until the frame's buffer index comes back in DequeueInputBuffer().
+  virtual bool UseDmabufInput() { return false; }
 
   virtual uint8_t GetH264LevelLimit(const EncoderConfig* config) = 0;
   virtual void StopDevicePoll() = 0;
@@ -4,6 +4,8 @@
 
 #include "video_frame.h"
 
+#include "video_frame_pool.h"
+
 namespace mcil {
 
 namespace {
@@ -261,6 +263,21 @@ scoped_refptr<VideoFrame> VideoFrame::Create(const Size& size) {
   return new VideoFrame(size);
 }
 
+// static
+void VideoFrameTraits::Destruct(const VideoFrame* frame) {
+  VideoFramePool* pool = frame->pool_;
+  if (pool == nullptr) {
+    delete frame;
+    return;
+  }
+
+  VideoFrame* pooled_frame = const_cast<VideoFrame*>(frame);
+  pooled_frame->pool_ = nullptr;
+  pool->Recycle(pooled_frame);
+  // May delete the pool, and the frame with it.
+  pool->Release();
+}
+
 VideoFrame::VideoFrame(const Size& size)
  :format(PIXEL_FORMAT_UNKNOWN),
   coded_size(size.width, size.height),
@@ -6,6 +6,7 @@
 #define SRC_BASE_VIDEO_FRAME_H_
 
 #include "codec_types.h"
+#include "inline_vector.h"
 
 namespace mcil {
 
@@ -25,7 +26,16 @@ class ColorPlane {
   size_t size = 0;
 };
 
-class VideoFrame : public RefCounted<VideoFrame> {
+class VideoFrame;
+class VideoFramePool;
+
+struct VideoFrameTraits {
+  // Hands a pooled frame back to its VideoFramePool instead of deleting it.
+  static void Destruct(const VideoFrame* frame);
+};
+
+class VideoFrame
+    : public RefCountedThreadSafe<VideoFrame, VideoFrameTraits> {
  public:
   enum {
     kYPlane = 0,
@@ -57,8 +67,9 @@ class VideoFrame : public RefCounted<VideoFrame> {
   VideoPixelFormat format;
   Size coded_size;
 
-  std::vector<ColorPlane> color_planes;
-  std::vector<int32_t> dmabuf_fds;
+  // Inline, a frame never has more than kMaxPlanes of either.
+  InlineVector<ColorPlane, kMaxPlanes> color_planes;
+  InlineVector<int32_t, kMaxPlanes> dmabuf_fds;
 
   struct timeval timestamp;
   bool is_multi_planar;
@@ -66,10 +77,15 @@ class VideoFrame : public RefCounted<VideoFrame> {
   const uint8_t* data[kMaxPlanes] = {};
 
  private:
-  friend class RefCounted<VideoFrame>;
+  friend class RefCountedThreadSafe<VideoFrame, VideoFrameTraits>;
+  friend class VideoFramePool;
+  friend struct VideoFrameTraits;
 
   VideoFrame(const Size& size);
   ~VideoFrame() = default;
+
+  // Set, with a reference held, while the frame is handed out by a pool.
+  VideoFramePool* pool_ = nullptr;
 };
 
 }  //  namespace mcil
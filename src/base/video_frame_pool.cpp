@@ -0,0 +1,117 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "video_frame_pool.h"
+
+#include "log.h"
+
+namespace mcil {
+
+bool VideoFramePool::Key::operator<(const Key& rhs) const {
+  if (format != rhs.format)
+    return format < rhs.format;
+  if (width != rhs.width)
+    return width < rhs.width;
+  return height < rhs.height;
+}
+
+// static
+scoped_refptr<VideoFramePool> VideoFramePool::Create(size_t max_free_frames) {
+  return new VideoFramePool(max_free_frames);
+}
+
+VideoFramePool::VideoFramePool(size_t max_free_frames)
+  : max_free_frames_(max_free_frames) {
+}
+
+VideoFramePool::~VideoFramePool() {
+  for (auto& entry : free_frames_) {
+    for (VideoFrame* frame : entry.second)
+      delete frame;
+  }
+}
+
+scoped_refptr<VideoFrame> VideoFramePool::CreateFrame(
+    VideoPixelFormat format, const Size& coded_size) {
+  VideoFrame* frame = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    auto it = free_frames_.find(Key{format, coded_size.width,
+                                    coded_size.height});
+    if ((it != free_frames_.end()) && !it->second.empty()) {
+      frame = it->second.back();
+      it->second.pop_back();
+    }
+  }
+
+  if (frame == nullptr) {
+    const size_t num_planes = VideoFrame::NumPlanes(format);
+    if (num_planes == 0) {
+      MCIL_ERROR_PRINT(": Unsupported video format: %d", format);
+      return nullptr;
+    }
+
+    frame = new VideoFrame(coded_size);
+    frame->format = format;
+    frame->color_planes.reserve(num_planes);
+    size_t offset = 0;
+    for (size_t i = 0; i < num_planes; ++i) {
+      const Size plane_size = VideoFrame::PlaneSize(format, i, coded_size);
+      frame->color_planes.emplace_back(
+          static_cast<int32_t>(plane_size.width), offset,
+          plane_size.GetArea());
+      offset += plane_size.GetArea();
+    }
+  }
+
+  // The planes are laid out back to back in a single buffer.
+  frame->is_multi_planar = false;
+
+  // Released by VideoFrameTraits::Destruct().
+  AddRef();
+  frame->pool_ = this;
+  return frame;
+}
+
+size_t VideoFramePool::FreeFramesCount() {
+  std::lock_guard<std::mutex> lock(lock_);
+  size_t count = 0;
+  for (const auto& entry : free_frames_)
+    count += entry.second.size();
+  return count;
+}
+
+void VideoFramePool::Recycle(VideoFrame* frame) {
+  memset(&frame->timestamp, 0, sizeof(frame->timestamp));
+  for (size_t i = 0; i < VideoFrame::kMaxPlanes; ++i)
+    frame->data[i] = nullptr;
+  frame->dmabuf_fds.clear();
+  frame->is_multi_planar = false;
+
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    std::vector<VideoFrame*>& frames = free_frames_[Key{
+        frame->format, frame->coded_size.width, frame->coded_size.height}];
+    if (frames.size() < max_free_frames_) {
+      frames.push_back(frame);
+      return;
+    }
+  }
+
+  delete frame;
+}
+
+}  // namespace mcil
@@ -0,0 +1,79 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef SRC_BASE_VIDEO_FRAME_POOL_H_
+#define SRC_BASE_VIDEO_FRAME_POOL_H_
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "video_frame.h"
+
+namespace mcil {
+
+// Recycles VideoFrames, e.g. the ones an encoder client creates for every
+// EncodeFrame(). Frames are keyed by format and coded size, and are handed
+// out with their color planes already laid out back to back in a single
+// buffer. When the last reference to a frame drops, it goes back to the
+// pool instead of being deleted, with its timestamp, data pointers, dmabuf
+// fds and is_multi_planar reset. Its format, coded size and color planes
+// must be left as handed out.
+class VideoFramePool : public RefCountedThreadSafe<VideoFramePool> {
+ public:
+  enum { kDefaultMaxFreeFrames = 8 };
+
+  // Keeps at most |max_free_frames| free frames of each format and size.
+  static scoped_refptr<VideoFramePool> Create(
+      size_t max_free_frames = kDefaultMaxFreeFrames);
+
+  VideoFramePool(const VideoFramePool&) = delete;
+  VideoFramePool& operator=(const VideoFramePool&) = delete;
+
+  // Can be called from any thread, frames can be released on any thread.
+  // Returns nullptr for formats without a known plane layout.
+  scoped_refptr<VideoFrame> CreateFrame(VideoPixelFormat format,
+                                        const Size& coded_size);
+
+  size_t FreeFramesCount();
+
+ private:
+  friend class RefCountedThreadSafe<VideoFramePool>;
+  friend struct VideoFrameTraits;
+
+  struct Key {
+    VideoPixelFormat format;
+    uint32_t width;
+    uint32_t height;
+
+    bool operator<(const Key& rhs) const;
+  };
+
+  explicit VideoFramePool(size_t max_free_frames);
+  ~VideoFramePool();
+
+  // Takes back |frame| once its last reference dropped.
+  void Recycle(VideoFrame* frame);
+
+  const size_t max_free_frames_;
+
+  std::mutex lock_;
+  std::map<Key, std::vector<VideoFrame*>> free_frames_;
+};
+
+}  // namespace mcil
+
+#endif  // SRC_BASE_VIDEO_FRAME_POOL_H_
@@ -0,0 +1,377 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Microbenchmarks for the per frame helpers of the base layer. Every
+// benchmark is calibrated to run for at least --min-time-ms and repeated
+// --repetitions times. Results are printed as JSON (default) or CSV so they
+// can be compared across releases.
+//
+//   mcil-base-benchmark [--format=json|csv] [--filter=<substring>]
+//                       [--min-time-ms=<ms>] [--repetitions=<n>]
+
+#include <sys/utsname.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "base/fourcc.h"
+#include "base/thread.h"
+#include "base/video_frame.h"
+#include "base/video_frame_pool.h"
+#include "v4l2/v4l2_buffers.h"
+
+namespace mcil {
+
+namespace {
+
+using BenchmarkClock = std::chrono::steady_clock;
+
+// Keeps the compiler from discarding |value| and the work producing it.
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Benchmark {
+  const char* name;
+  // Runs the measured operation |iterations| times.
+  std::function<void(size_t iterations)> run;
+};
+
+struct BenchmarkResult {
+  std::string name;
+  size_t iterations = 0;
+  size_t repetitions = 0;
+  double min_ns = 0;
+  double median_ns = 0;
+  double max_ns = 0;
+};
+
+struct Options {
+  bool csv = false;
+  std::string filter;
+  uint32_t min_time_ms = 200;
+  uint32_t repetitions = 5;
+};
+
+const Size kFrameSize(1920, 1080);
+
+class BenchmarkObject : public RefCounted<BenchmarkObject> {
+ public:
+  BenchmarkObject() = default;
+
+ private:
+  friend class RefCounted<BenchmarkObject>;
+  ~BenchmarkObject() = default;
+};
+
+class ThreadSafeBenchmarkObject
+    : public RefCountedThreadSafe<ThreadSafeBenchmarkObject> {
+ public:
+  ThreadSafeBenchmarkObject() = default;
+
+ private:
+  friend class RefCountedThreadSafe<ThreadSafeBenchmarkObject>;
+  ~ThreadSafeBenchmarkObject() = default;
+};
+
+void BM_AllocationSize(size_t iterations) {
+  const VideoPixelFormat formats[] = {
+      PIXEL_FORMAT_I420, PIXEL_FORMAT_NV12, PIXEL_FORMAT_ARGB};
+  for (size_t i = 0; i < iterations; ++i)
+    DoNotOptimize(VideoFrame::AllocationSize(formats[i % 3], kFrameSize));
+}
+
+void BM_PlaneSize(size_t iterations) {
+  for (size_t i = 0; i < iterations; ++i) {
+    DoNotOptimize(
+        VideoFrame::PlaneSize(PIXEL_FORMAT_I420, i % 3, kFrameSize));
+  }
+}
+
+// An I420 frame laid out by hand, like an encoder client does for every
+// EncodeFrame().
+void BM_VideoFrameCreateRelease(size_t iterations) {
+  for (size_t i = 0; i < iterations; ++i) {
+    scoped_refptr<VideoFrame> frame = VideoFrame::Create(kFrameSize);
+    frame->format = PIXEL_FORMAT_I420;
+    size_t offset = 0;
+    for (size_t plane = 0; plane < 3; ++plane) {
+      const Size plane_size =
+          VideoFrame::PlaneSize(PIXEL_FORMAT_I420, plane, kFrameSize);
+      frame->color_planes.emplace_back(
+          static_cast<int32_t>(plane_size.width), offset,
+          plane_size.GetArea());
+      offset += plane_size.GetArea();
+    }
+    DoNotOptimize(frame.get());
+  }
+}
+
+void BM_VideoFramePoolCreateRelease(size_t iterations) {
+  scoped_refptr<VideoFramePool> pool = VideoFramePool::Create();
+  for (size_t i = 0; i < iterations; ++i) {
+    scoped_refptr<VideoFrame> frame =
+        pool->CreateFrame(PIXEL_FORMAT_I420, kFrameSize);
+    DoNotOptimize(frame.get());
+  }
+}
+
+void BM_FourccFromVideoPixelFormat(size_t iterations) {
+  const VideoPixelFormat formats[] = {
+      PIXEL_FORMAT_I420, PIXEL_FORMAT_NV12, PIXEL_FORMAT_ARGB};
+  for (size_t i = 0; i < iterations; ++i) {
+    DoNotOptimize(
+        Fourcc::FromVideoPixelFormat(formats[i % 3], (i & 1) == 0));
+  }
+}
+
+void BM_FourccFromV4L2PixFmt(size_t iterations) {
+  const uint32_t pix_fmts[] = {
+      V4L2_PIX_FMT_NV12, V4L2_PIX_FMT_NV12M, V4L2_PIX_FMT_YUV420M};
+  for (size_t i = 0; i < iterations; ++i)
+    DoNotOptimize(Fourcc::FromV4L2PixFmt(pix_fmts[i % 3]));
+}
+
+void BM_ScopedRefptrCopy(size_t iterations) {
+  scoped_refptr<BenchmarkObject> object(new BenchmarkObject());
+  for (size_t i = 0; i < iterations; ++i) {
+    scoped_refptr<BenchmarkObject> copy(object);
+    DoNotOptimize(copy.get());
+  }
+}
+
+void BM_ScopedRefptrCopyThreadSafe(size_t iterations) {
+  scoped_refptr<ThreadSafeBenchmarkObject> object(
+      new ThreadSafeBenchmarkObject());
+  for (size_t i = 0; i < iterations; ++i) {
+    scoped_refptr<ThreadSafeBenchmarkObject> copy(object);
+    DoNotOptimize(copy.get());
+  }
+}
+
+void BM_ScopedRefptrCreateRelease(size_t iterations) {
+  for (size_t i = 0; i < iterations; ++i) {
+    scoped_refptr<BenchmarkObject> object(new BenchmarkObject());
+    DoNotOptimize(object.get());
+  }
+}
+
+// Posts one task at a time and waits for it to run, like the decoder and
+// encoder poll threads do for every device wakeup.
+void BM_ThreadPostTaskRoundTrip(size_t iterations) {
+  Thread thread("BenchmarkThread");
+  thread.Start();
+
+  std::mutex lock;
+  std::condition_variable condition;
+  size_t completed = 0;
+  for (size_t i = 0; i < iterations; ++i) {
+    thread.PostTask([&lock, &condition, &completed]() {
+      std::lock_guard<std::mutex> auto_lock(lock);
+      ++completed;
+      condition.notify_one();
+    });
+
+    std::unique_lock<std::mutex> auto_lock(lock);
+    condition.wait(auto_lock, [&completed, i]() { return completed > i; });
+  }
+
+  thread.Stop();
+}
+
+// Posts every task back to back and waits for the last one only.
+void BM_ThreadPostTaskThroughput(size_t iterations) {
+  Thread thread("BenchmarkThread");
+  thread.Start();
+
+  std::atomic<size_t> completed{0};
+  for (size_t i = 0; i < iterations; ++i) {
+    thread.PostTask([&completed]() {
+      completed.fetch_add(1, std::memory_order_relaxed);
+    });
+  }
+
+  thread.Stop();
+  DoNotOptimize(completed.load());
+}
+
+void BM_V4L2BuffersListGetReturn(size_t iterations) {
+  scoped_refptr<V4L2BuffersList> free_buffers(new V4L2BuffersList());
+  for (size_t i = 0; i < 8; ++i)
+    free_buffers->ReturnBuffer(i);
+
+  for (size_t i = 0; i < iterations; ++i) {
+    Optional<size_t> buffer_id = free_buffers->GetFreeBuffer();
+    DoNotOptimize(buffer_id);
+    free_buffers->ReturnBuffer(*buffer_id);
+  }
+}
+
+const Benchmark kBenchmarks[] = {
+  {"VideoFrame_AllocationSize", BM_AllocationSize},
+  {"VideoFrame_PlaneSize", BM_PlaneSize},
+  {"VideoFrame_CreateRelease", BM_VideoFrameCreateRelease},
+  {"VideoFramePool_CreateRelease", BM_VideoFramePoolCreateRelease},
+  {"Fourcc_FromVideoPixelFormat", BM_FourccFromVideoPixelFormat},
+  {"Fourcc_FromV4L2PixFmt", BM_FourccFromV4L2PixFmt},
+  {"ScopedRefptr_Copy", BM_ScopedRefptrCopy},
+  {"ScopedRefptr_CopyThreadSafe", BM_ScopedRefptrCopyThreadSafe},
+  {"ScopedRefptr_CreateRelease", BM_ScopedRefptrCreateRelease},
+  {"Thread_PostTaskRoundTrip", BM_ThreadPostTaskRoundTrip},
+  {"Thread_PostTaskThroughput", BM_ThreadPostTaskThroughput},
+  {"V4L2BuffersList_GetReturn", BM_V4L2BuffersListGetReturn},
+};
+
+double RunOnce(const Benchmark& benchmark, size_t iterations) {
+  BenchmarkClock::time_point start = BenchmarkClock::now();
+  benchmark.run(iterations);
+  std::chrono::duration<double, std::nano> elapsed =
+      BenchmarkClock::now() - start;
+  return elapsed.count();
+}
+
+BenchmarkResult RunBenchmark(const Benchmark& benchmark,
+                             const Options& options) {
+  const double min_time_ns = options.min_time_ms * 1e6;
+
+  // Grow the iteration count until a single run takes long enough.
+  size_t iterations = 1;
+  double elapsed_ns = RunOnce(benchmark, iterations);
+  while ((elapsed_ns < min_time_ns) && (iterations < (1ULL << 40))) {
+    double scale = (elapsed_ns > 0) ? (min_time_ns * 1.2 / elapsed_ns) : 10;
+    scale = std::min(std::max(scale, 2.0), 100.0);
+    iterations = static_cast<size_t>(iterations * scale);
+    elapsed_ns = RunOnce(benchmark, iterations);
+  }
+
+  std::vector<double> ns_per_op;
+  ns_per_op.push_back(elapsed_ns / iterations);
+  while (ns_per_op.size() < options.repetitions)
+    ns_per_op.push_back(RunOnce(benchmark, iterations) / iterations);
+  std::sort(ns_per_op.begin(), ns_per_op.end());
+
+  BenchmarkResult result;
+  result.name = benchmark.name;
+  result.iterations = iterations;
+  result.repetitions = ns_per_op.size();
+  result.min_ns = ns_per_op.front();
+  result.median_ns = ns_per_op[ns_per_op.size() / 2];
+  result.max_ns = ns_per_op.back();
+  return result;
+}
+
+void PrintJson(const std::vector<BenchmarkResult>& results) {
+  char date[64] = {};
+  time_t now = time(nullptr);
+  struct tm local_time;
+  strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z",
+           localtime_r(&now, &local_time));
+
+  struct utsname host;
+  memset(&host, 0, sizeof(host));
+  uname(&host);
+
+  printf("{\n");
+  printf("  \"context\": {\n");
+  printf("    \"date\": \"%s\",\n", date);
+  printf("    \"host\": \"%s\",\n", host.nodename);
+  printf("    \"machine\": \"%s\",\n", host.machine);
+  printf("    \"kernel\": \"%s\",\n", host.release);
+  printf("    \"num_cpus\": %ld,\n", sysconf(_SC_NPROCESSORS_ONLN));
+  printf("    \"compiler\": \"%s\"\n", __VERSION__);
+  printf("  },\n");
+  printf("  \"benchmarks\": [\n");
+  for (size_t i = 0; i < results.size(); ++i) {
+    const BenchmarkResult& result = results[i];
+    printf("    {\"name\": \"%s\", \"iterations\": %zu, "
+           "\"repetitions\": %zu, \"min_ns\": %.3f, \"median_ns\": %.3f, "
+           "\"max_ns\": %.3f}%s\n",
+           result.name.c_str(), result.iterations, result.repetitions,
+           result.min_ns, result.median_ns, result.max_ns,
+           (i + 1 < results.size()) ? "," : "");
+  }
+  printf("  ]\n");
+  printf("}\n");
+}
+
+void PrintCsv(const std::vector<BenchmarkResult>& results) {
+  printf("name,iterations,repetitions,min_ns,median_ns,max_ns\n");
+  for (const auto& result : results) {
+    printf("%s,%zu,%zu,%.3f,%.3f,%.3f\n", result.name.c_str(),
+           result.iterations, result.repetitions, result.min_ns,
+           result.median_ns, result.max_ns);
+  }
+}
+
+bool ParseOptions(int argc, char** argv, Options* options) {
+  for (int i = 1; i < argc; ++i) {
+    std::string arg(argv[i]);
+    if (arg == "--format=json") {
+      options->csv = false;
+    } else if (arg == "--format=csv") {
+      options->csv = true;
+    } else if (arg.compare(0, 9, "--filter=") == 0) {
+      options->filter = arg.substr(9);
+    } else if (arg.compare(0, 14, "--min-time-ms=") == 0) {
+      options->min_time_ms = static_cast<uint32_t>(atoi(arg.c_str() + 14));
+    } else if (arg.compare(0, 14, "--repetitions=") == 0) {
+      options->repetitions = static_cast<uint32_t>(atoi(arg.c_str() + 14));
+    } else {
+      fprintf(stderr, "Usage: %s [--format=json|csv] [--filter=<substring>] "
+              "[--min-time-ms=<ms>] [--repetitions=<n>]\n", argv[0]);
+      return false;
+    }
+  }
+
+  options->repetitions = std::max<uint32_t>(options->repetitions, 1);
+  return true;
+}
+
+}  // namespace
+
+}  // namespace mcil
+
+int main(int argc, char** argv) {
+  mcil::Options options;
+  if (!mcil::ParseOptions(argc, argv, &options))
+    return 1;
+
+  std::vector<mcil::BenchmarkResult> results;
+  for (const auto& benchmark : mcil::kBenchmarks) {
+    if (!options.filter.empty() &&
+        (strstr(benchmark.name, options.filter.c_str()) == nullptr))
+      continue;
+    results.push_back(mcil::RunBenchmark(benchmark, options));
+  }
+
+  if (options.csv)
+    mcil::PrintCsv(results);
+  else
+    mcil::PrintJson(results);
+  return 0;
+}
@@ -0,0 +1,198 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Decode and encode loop benchmarks. V4L2VideoDecoder and V4L2VideoEncoder
+// run end to end on FakeV4L2Device (USE_V4L2_DEVICE=FAKE), so the library
+// overhead per frame (buffer bookkeeping, device poll and client thread
+// handoff) is measured without hardware. Every loop is repeated
+// --repetitions times, results are printed as JSON (default) or CSV.
+//
+//   mcil-codec-benchmark [--format=json|csv] [--filter=<substring>]
+//                        [--frames=<n>] [--repetitions=<n>]
+//                        [--latency-us=<us>]
+
+#include <sys/utsname.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "codec_loops.h"
+#include "v4l2/fake_v4l2_device.h"
+
+namespace mcil {
+
+namespace {
+
+struct Options {
+  bool csv = false;
+  std::string filter;
+  size_t frames = 300;
+  uint32_t repetitions = 5;
+  uint32_t latency_us = 0;
+};
+
+struct Benchmark {
+  const char* name;
+  // One of the codec loops of codec_loops.h.
+  double (*run)(size_t frames);
+};
+
+struct BenchmarkResult {
+  std::string name;
+  size_t frames = 0;
+  size_t repetitions = 0;
+  double min_ns = 0;
+  double median_ns = 0;
+  double max_ns = 0;
+};
+
+const Benchmark kBenchmarks[] = {
+  {"V4L2VideoDecoder_DecodeLoop", RunDecodeLoop},
+  {"V4L2VideoEncoder_EncodeLoop", RunEncodeLoop},
+};
+
+bool RunBenchmark(const Benchmark& benchmark, const Options& options,
+                  BenchmarkResult* result) {
+  std::vector<double> ns_per_frame;
+  while (ns_per_frame.size() < options.repetitions) {
+    double elapsed_ns = benchmark.run(options.frames);
+    if (elapsed_ns < 0)
+      return false;
+    ns_per_frame.push_back(elapsed_ns / options.frames);
+  }
+  std::sort(ns_per_frame.begin(), ns_per_frame.end());
+
+  result->name = benchmark.name;
+  result->frames = options.frames;
+  result->repetitions = ns_per_frame.size();
+  result->min_ns = ns_per_frame.front();
+  result->median_ns = ns_per_frame[ns_per_frame.size() / 2];
+  result->max_ns = ns_per_frame.back();
+  return true;
+}
+
+void PrintJson(const std::vector<BenchmarkResult>& results,
+               const Options& options) {
+  char date[64] = {};
+  time_t now = time(nullptr);
+  struct tm local_time;
+  strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z",
+           localtime_r(&now, &local_time));
+
+  struct utsname host;
+  memset(&host, 0, sizeof(host));
+  uname(&host);
+
+  printf("{\n");
+  printf("  \"context\": {\n");
+  printf("    \"date\": \"%s\",\n", date);
+  printf("    \"host\": \"%s\",\n", host.nodename);
+  printf("    \"machine\": \"%s\",\n", host.machine);
+  printf("    \"kernel\": \"%s\",\n", host.release);
+  printf("    \"num_cpus\": %ld,\n", sysconf(_SC_NPROCESSORS_ONLN));
+  printf("    \"compiler\": \"%s\",\n", __VERSION__);
+  printf("    \"device\": \"fake\",\n");
+  printf("    \"device_latency_us\": %u\n", options.latency_us);
+  printf("  },\n");
+  printf("  \"benchmarks\": [\n");
+  for (size_t i = 0; i < results.size(); ++i) {
+    const BenchmarkResult& result = results[i];
+    printf("    {\"name\": \"%s\", \"frames\": %zu, "
+           "\"repetitions\": %zu, \"min_ns\": %.3f, \"median_ns\": %.3f, "
+           "\"max_ns\": %.3f}%s\n",
+           result.name.c_str(), result.frames, result.repetitions,
+           result.min_ns, result.median_ns, result.max_ns,
+           (i + 1 < results.size()) ? "," : "");
+  }
+  printf("  ]\n");
+  printf("}\n");
+}
+
+void PrintCsv(const std::vector<BenchmarkResult>& results) {
+  printf("name,frames,repetitions,min_ns,median_ns,max_ns\n");
+  for (const auto& result : results) {
+    printf("%s,%zu,%zu,%.3f,%.3f,%.3f\n", result.name.c_str(),
+           result.frames, result.repetitions, result.min_ns,
+           result.median_ns, result.max_ns);
+  }
+}
+
+bool ParseOptions(int argc, char** argv, Options* options) {
+  for (int i = 1; i < argc; ++i) {
+    std::string arg(argv[i]);
+    if (arg == "--format=json") {
+      options->csv = false;
+    } else if (arg == "--format=csv") {
+      options->csv = true;
+    } else if (arg.compare(0, 9, "--filter=") == 0) {
+      options->filter = arg.substr(9);
+    } else if (arg.compare(0, 9, "--frames=") == 0) {
+      options->frames = static_cast<size_t>(atoi(arg.c_str() + 9));
+    } else if (arg.compare(0, 14, "--repetitions=") == 0) {
+      options->repetitions = static_cast<uint32_t>(atoi(arg.c_str() + 14));
+    } else if (arg.compare(0, 13, "--latency-us=") == 0) {
+      options->latency_us = static_cast<uint32_t>(atoi(arg.c_str() + 13));
+    } else {
+      fprintf(stderr, "Usage: %s [--format=json|csv] [--filter=<substring>] "
+              "[--frames=<n>] [--repetitions=<n>] [--latency-us=<us>]\n",
+              argv[0]);
+      return false;
+    }
+  }
+
+  options->frames = std::max<size_t>(options->frames, 1);
+  options->repetitions = std::max<uint32_t>(options->repetitions, 1);
+  return true;
+}
+
+}  // namespace
+
+}  // namespace mcil
+
+int main(int argc, char** argv) {
+  mcil::Options options;
+  if (!mcil::ParseOptions(argc, argv, &options))
+    return 1;
+
+  setenv("USE_V4L2_DEVICE", "FAKE", 1);
+  mcil::FakeV4L2Device::Config config = mcil::FakeV4L2Device::GetConfig();
+  config.latencies_us.assign(1, options.latency_us);
+  mcil::FakeV4L2Device::SetConfig(config);
+
+  std::vector<mcil::BenchmarkResult> results;
+  for (const auto& benchmark : mcil::kBenchmarks) {
+    if (!options.filter.empty() &&
+        (strstr(benchmark.name, options.filter.c_str()) == nullptr))
+      continue;
+
+    mcil::BenchmarkResult result;
+    if (!mcil::RunBenchmark(benchmark, options, &result))
+      return 2;
+    results.push_back(result);
+  }
+
+  if (options.csv)
+    mcil::PrintCsv(results);
+  else
+    mcil::PrintJson(results, options);
+  return 0;
+}
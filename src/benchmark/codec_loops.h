@@ -0,0 +1,57 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef SRC_BENCHMARK_CODEC_LOOPS_H_
+#define SRC_BENCHMARK_CODEC_LOOPS_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+#include "base/thread.h"
+
+namespace mcil {
+
+// A loop making no progress for this long is reported as failed.
+const std::chrono::seconds kCodecLoopStallTimeout(10);
+
+// Each loop creates its codec on FakeV4L2Device, runs |frames| frames
+// through it from a client thread and destroys it. Returns the elapsed time
+// in nanoseconds, or a negative value on failure.
+double RunDecodeLoop(size_t frames);
+double RunEncodeLoop(size_t frames);
+
+// Runs |task| on |thread| and waits for it to finish.
+template <typename Task>
+inline void RunOnThread(Thread* thread, Task task) {
+  std::mutex lock;
+  std::condition_variable condition;
+  bool done = false;
+  thread->PostTask([&task, &lock, &condition, &done]() {
+    task();
+    std::lock_guard<std::mutex> auto_lock(lock);
+    done = true;
+    condition.notify_one();
+  });
+
+  std::unique_lock<std::mutex> auto_lock(lock);
+  condition.wait(auto_lock, [&done]() { return done; });
+}
+
+}  // namespace mcil
+
+#endif  // SRC_BENCHMARK_CODEC_LOOPS_H_
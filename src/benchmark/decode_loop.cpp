@@ -0,0 +1,205 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "codec_loops.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "base/video_decoder_client.h"
+#include "v4l2/v4l2_video_decoder.h"
+
+namespace mcil {
+
+namespace {
+
+using BenchmarkClock = std::chrono::steady_clock;
+
+const Size kDecodeFrameSize(1920, 1080);
+const size_t kAccessUnitSize = 20000;
+
+// Feeds |frames| access units and a flush from the client thread, as fast
+// as the decoder takes them, and waits for the flush to complete.
+class DecodeLoopClient : public VideoDecoderClient {
+ public:
+  explicit DecodeLoopClient(size_t frames)
+    : thread_(new Thread("BenchmarkDecodeClient")),
+      frames_(frames),
+      access_unit_(kAccessUnitSize, 0) {}
+
+  double Run() {
+    thread_->Start();
+    decoder_ = V4L2VideoDecoder::Create();
+
+    DecoderConfig config;
+    config.frameWidth = kDecodeFrameSize.width;
+    config.frameHeight = kDecodeFrameSize.height;
+    config.profile = H264PROFILE_MAIN;
+    config.outputMode = OUTPUT_ALLOCATE;
+    DecoderClientConfig client_config;
+
+    BenchmarkClock::time_point start = BenchmarkClock::now();
+    bool initialized = false;
+    RunOnThread(thread_.get(), [this, &config, &client_config, &initialized]() {
+      initialized = decoder_->Initialize(&config, this, &client_config, 0);
+      if (initialized)
+        Feed();
+    });
+
+    bool completed = initialized && WaitForCompletion();
+    std::chrono::duration<double, std::nano> elapsed =
+        BenchmarkClock::now() - start;
+
+    RunOnThread(thread_.get(), [this]() {
+      decoder_->Destroy();
+      destroyed_ = true;
+    });
+    thread_->Stop();
+
+    if (!completed || (decoded_ != frames_)) {
+      fprintf(stderr, "Decode loop failed: %zu of %zu frames\n",
+              decoded_.load(), frames_);
+      return -1;
+    }
+    return elapsed.count();
+  }
+
+  // VideoDecoderClient implementation.
+  bool CreateOutputBuffers(VideoPixelFormat pixel_format,
+                           uint32_t buffer_count,
+                           uint32_t texture_target) override {
+    std::vector<WritableBufferRef*> buffers(buffer_count);
+    if (!decoder_->AllocateOutputBuffers(buffer_count, buffers))
+      return false;
+    for (WritableBufferRef* buffer : buffers)
+      delete buffer;
+    return true;
+  }
+  bool DestroyOutputBuffers() override { return true; }
+  void ScheduleDecodeBufferTaskIfNeeded() override { Feed(); }
+  void StartResolutionChange() override {}
+  void NotifyFlushDone() override { Complete(false); }
+  void NotifyFlushDoneIfNeeded() override {
+    if (flushing_ && decoder_->DidFlushBuffersDone()) {
+      flushing_ = false;
+      Complete(false);
+    }
+  }
+  void NotifyResetDone() override {}
+  bool IsDestroyPending() override { return false; }
+  void OnStartDevicePoll() override {}
+  void OnStopDevicePoll() override {}
+  void CreateBuffersForFormat(const Size& coded_size,
+                              const Size& visible_size) override {}
+  void SendBufferToClient(size_t buffer_index, int32_t buffer_id,
+                          ReadableBufferRef buffer) override {
+    decoded_++;
+    Progress();
+  }
+  void CheckGLFences() override {}
+  void NotifyDecoderError(DecoderError error) override {
+    fprintf(stderr, "Decoder error: %d\n", error);
+    Complete(true);
+  }
+  void NotifyDecodeBufferTask(bool event_pending, bool has_output) override {
+    thread_->PostTask([this, event_pending, has_output]() {
+      if (!destroyed_)
+        decoder_->RunDecodeBufferTask(event_pending, has_output);
+    });
+  }
+  void NotifyDecoderPostTask(PostTaskType task, bool value) override {}
+  void NotifyDecodeBufferDone() override {}
+
+ private:
+  void Feed() {
+    while (fed_ < frames_) {
+      if (!decoder_->DecodeBuffer(access_unit_.data(), access_unit_.size(),
+                                  static_cast<int32_t>(fed_),
+                                  static_cast<int64_t>(fed_))) {
+        return;
+      }
+      decoder_->FlushInputBuffers();
+      fed_++;
+    }
+
+    if (!flush_sent_) {
+      if (!decoder_->DecodeBuffer(nullptr, 0, kFlushBufferId, 0))
+        return;
+      flush_sent_ = flushing_ = true;
+      decoder_->FlushInputBuffers();
+    }
+  }
+
+  void Progress() {
+    std::lock_guard<std::mutex> auto_lock(lock_);
+    progress_++;
+    condition_.notify_one();
+  }
+
+  void Complete(bool failed) {
+    std::lock_guard<std::mutex> auto_lock(lock_);
+    done_ = true;
+    failed_ = failed;
+    condition_.notify_one();
+  }
+
+  bool WaitForCompletion() {
+    std::unique_lock<std::mutex> auto_lock(lock_);
+    while (!done_) {
+      size_t progress = progress_;
+      if (!condition_.wait_for(auto_lock, kCodecLoopStallTimeout,
+                               [this, progress]() {
+                                 return done_ || (progress_ != progress);
+                               })) {
+        return false;
+      }
+    }
+    return !failed_;
+  }
+
+  std::unique_ptr<Thread> thread_;
+  scoped_refptr<VideoDecoder> decoder_;
+  const size_t frames_;
+  std::vector<uint8_t> access_unit_;
+
+  // Client thread only.
+  size_t fed_ = 0;
+  bool flush_sent_ = false;
+  bool flushing_ = false;
+  bool destroyed_ = false;
+
+  std::atomic<size_t> decoded_{0};
+
+  std::mutex lock_;
+  std::condition_variable condition_;
+  size_t progress_ = 0;
+  bool done_ = false;
+  bool failed_ = false;
+};
+
+}  // namespace
+
+double RunDecodeLoop(size_t frames) {
+  DecodeLoopClient client(frames);
+  return client.Run();
+}
+
+}  // namespace mcil
@@ -0,0 +1,191 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "codec_loops.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "base/video_encoder_client.h"
+#include "base/video_frame_pool.h"
+#include "v4l2/v4l2_video_encoder.h"
+
+namespace mcil {
+
+namespace {
+
+using BenchmarkClock = std::chrono::steady_clock;
+
+const Size kEncodeFrameSize(1280, 720);
+// Frames handed to the encoder ahead of the bitstream coming back.
+const size_t kMaxEncodeFramesInFlight = 4;
+
+// Encodes |frames| pooled I420 frames, keeping a few in flight, then
+// flushes and waits for the last bitstream buffer.
+class EncodeLoopClient : public VideoEncoderClient {
+ public:
+  explicit EncodeLoopClient(size_t frames)
+    : thread_(new Thread("BenchmarkEncodeClient")),
+      frames_(frames),
+      frame_pool_(VideoFramePool::Create()),
+      frame_data_(VideoFrame::AllocationSize(PIXEL_FORMAT_I420,
+                                             kEncodeFrameSize), 0) {}
+
+  double Run() {
+    thread_->Start();
+    encoder_ = V4L2VideoEncoder::Create();
+
+    EncoderConfig config;
+    config.frameRate = 30;
+    config.bitRate = 4000000;
+    config.width = kEncodeFrameSize.width;
+    config.height = kEncodeFrameSize.height;
+    config.pixelFormat = PIXEL_FORMAT_I420;
+    config.outputBufferSize = 1 << 20;
+    config.h264OutputLevel = 40;
+    config.gopLength = 30;
+    config.profile = H264PROFILE_MAIN;
+    EncoderClientConfig client_config;
+
+    bool initialized = false;
+    RunOnThread(thread_.get(), [this, &config, &client_config, &initialized]() {
+      initialized = encoder_->Initialize(&config, this, &client_config, 0) &&
+                    encoder_->StartDevicePoll();
+    });
+
+    BenchmarkClock::time_point start = BenchmarkClock::now();
+    bool completed = initialized && EncodeFrames();
+    std::chrono::duration<double, std::nano> elapsed =
+        BenchmarkClock::now() - start;
+
+    RunOnThread(thread_.get(), [this]() {
+      encoder_->Destroy();
+      destroyed_ = true;
+    });
+    thread_->Stop();
+
+    if (!completed || (encoded_ != frames_)) {
+      fprintf(stderr, "Encode loop failed: %zu of %zu frames\n",
+              encoded_, frames_);
+      return -1;
+    }
+    return elapsed.count();
+  }
+
+  // VideoEncoderClient implementation.
+  void CreateInputBuffers(size_t count) override {}
+  void DestroyInputBuffers() override {}
+  void EnqueueInputBuffer(size_t buffer_index) override {}
+  void DequeueInputBuffer(size_t buffer_index) override {}
+  void BitstreamBufferReady(ReadableBufferRef buffer) override {
+    std::lock_guard<std::mutex> auto_lock(lock_);
+    if (buffer->IsLast())
+      done_ = true;
+    else
+      encoded_++;
+    condition_.notify_one();
+  }
+  void BitstreamBufferReady(const uint8_t* buffer, size_t buffer_size,
+                            uint64_t timestamp, bool is_key_frame) override {}
+  void PumpBitstreamBuffers() override {}
+  uint8_t GetH264LevelLimit(const EncoderConfig* config) override {
+    return config->h264OutputLevel;
+  }
+  void StopDevicePoll() override {}
+  void NotifyFlushIfNeeded(bool flush) override {}
+  void NotifyEncodeBufferTask() override {
+    thread_->PostTask([this]() {
+      if (!destroyed_)
+        encoder_->RunEncodeBufferTask();
+    });
+  }
+  void NotifyEncoderError(EncoderError error) override {
+    fprintf(stderr, "Encoder error: %d\n", error);
+    std::lock_guard<std::mutex> auto_lock(lock_);
+    failed_ = true;
+    condition_.notify_one();
+  }
+  void NotifyEncoderState(CodecState state) override {}
+
+ private:
+  bool EncodeFrames() {
+    for (size_t i = 0; i < frames_; ++i) {
+      // Released by the encoder once copied, and back to |frame_pool_|.
+      scoped_refptr<VideoFrame> frame =
+          frame_pool_->CreateFrame(PIXEL_FORMAT_I420, kEncodeFrameSize);
+      frame->data[0] = frame_data_.data();
+      frame->timestamp.tv_usec = static_cast<long>(i);
+      thread_->PostTask([this, frame]() {
+        encoder_->EncodeFrame(frame, false);
+      });
+
+      if ((i >= kMaxEncodeFramesInFlight) &&
+          !WaitFor(i + 1 - kMaxEncodeFramesInFlight, false)) {
+        return false;
+      }
+    }
+
+    thread_->PostTask([this]() { encoder_->FlushFrames(); });
+    return WaitFor(frames_, true);
+  }
+
+  // Waits until at least |encoded| frames came back, and for the last
+  // bitstream buffer too when |last|.
+  bool WaitFor(size_t encoded, bool last) {
+    std::unique_lock<std::mutex> auto_lock(lock_);
+    while (!failed_ && ((encoded_ < encoded) || (last && !done_))) {
+      size_t progress = encoded_;
+      if (!condition_.wait_for(auto_lock, kCodecLoopStallTimeout,
+                               [this, progress]() {
+                                 return failed_ || done_ ||
+                                        (encoded_ != progress);
+                               })) {
+        return false;
+      }
+    }
+    return !failed_;
+  }
+
+  std::unique_ptr<Thread> thread_;
+  scoped_refptr<VideoEncoder> encoder_;
+  const size_t frames_;
+  scoped_refptr<VideoFramePool> frame_pool_;
+  std::vector<uint8_t> frame_data_;
+
+  // Client thread only.
+  bool destroyed_ = false;
+
+  std::mutex lock_;
+  std::condition_variable condition_;
+  size_t encoded_ = 0;
+  bool done_ = false;
+  bool failed_ = false;
+};
+
+}  // namespace
+
+double RunEncodeLoop(size_t frames) {
+  EncodeLoopClient client(frames);
+  return client.Run();
+}
+
+}  // namespace mcil
@@ -0,0 +1,961 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "fake_v4l2_device.h"
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include "base/log.h"
+
+namespace mcil {
+
+namespace {
+
+const uint32_t kMinResolution = 16;
+const uint32_t kMaxWidth = 4096;
+const uint32_t kMaxHeight = 2304;
+const uint32_t kCodedAlignment = 16;
+const uint32_t kDefaultBitstreamBufferSize = 1024 * 1024;
+
+// Fake mmap offsets: queue slot, buffer index and plane packed in one word.
+uint32_t MemOffset(uint32_t slot, uint32_t index, uint32_t plane) {
+  return (slot << 24) | (index << 16) | (plane << 12);
+}
+
+int32_t Fail(int32_t error) {
+  errno = error;
+  return -1;
+}
+
+uint32_t Align(uint32_t value, uint32_t alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+FakeV4L2Device::Config ConfigFromEnvironment() {
+  FakeV4L2Device::Config config;
+
+  const char* latencies = std::getenv("FAKE_V4L2_LATENCY_US");
+  if (latencies != nullptr) {
+    std::stringstream stream(latencies);
+    std::string value;
+    while (std::getline(stream, value, ','))
+      config.latencies_us.push_back(
+          static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10)));
+  }
+
+  const char* coded_size = std::getenv("FAKE_V4L2_CODED_SIZE");
+  uint32_t width = 0;
+  uint32_t height = 0;
+  if ((coded_size != nullptr) &&
+      (sscanf(coded_size, "%ux%u", &width, &height) == 2) &&
+      (width > 0) && (height > 0)) {
+    config.coded_size.SetSize(width, height);
+  }
+
+  return config;
+}
+
+std::mutex& ConfigLock() {
+  static std::mutex config_lock;
+  return config_lock;
+}
+
+FakeV4L2Device::Config& CurrentConfig() {
+  static FakeV4L2Device::Config config = ConfigFromEnvironment();
+  return config;
+}
+
+bool IsRawFormat(uint32_t pixelformat) {
+  auto fourcc = Fourcc::FromV4L2PixFmt(pixelformat);
+  return fourcc && (fourcc->ToVideoPixelFormat() != PIXEL_FORMAT_UNKNOWN);
+}
+
+}  // namespace
+
+// static
+void FakeV4L2Device::SetConfig(const Config& config) {
+  std::lock_guard<std::mutex> lock(ConfigLock());
+  CurrentConfig() = config;
+}
+
+// static
+FakeV4L2Device::Config FakeV4L2Device::GetConfig() {
+  std::lock_guard<std::mutex> lock(ConfigLock());
+  return CurrentConfig();
+}
+
+FakeV4L2Device::FakeV4L2Device(DeviceType device_type)
+  : V4L2Device(device_type),
+    config_(GetConfig()),
+    type_(device_type) {
+  queues_[kOutputSlot].type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
+  queues_[kCaptureSlot].type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+  for (auto& queue : queues_)
+    memset(&queue.format, 0, sizeof(queue.format));
+}
+
+FakeV4L2Device::~FakeV4L2Device() noexcept(false) {
+  if (device_fd_ != -1)
+    close(device_fd_);
+  if (device_poll_interrupt_fd_ != -1)
+    close(device_poll_interrupt_fd_);
+}
+
+bool FakeV4L2Device::Initialize() {
+  return true;
+}
+
+bool FakeV4L2Device::Open(DeviceType type, uint32_t v4l2_pixfmt) {
+  uint32_t coded_type = IsDecoder() ? V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE
+                                    : V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+  const auto formats = SupportedFormats(coded_type);
+  if (std::find(formats.begin(), formats.end(), v4l2_pixfmt) ==
+      formats.end()) {
+    MCIL_ERROR_PRINT(": No devices supporting: %s",
+                     FourccToString(v4l2_pixfmt).c_str());
+    return false;
+  }
+
+  if (device_fd_ != -1)
+    return true;
+
+  uint32_t flags = static_cast<uint32_t>(EFD_NONBLOCK) |
+                   static_cast<uint32_t>(EFD_CLOEXEC);
+  device_fd_ = eventfd(0, flags);
+  device_poll_interrupt_fd_ = eventfd(0, flags);
+  if ((device_fd_ < 0) || (device_poll_interrupt_fd_ < 0)) {
+    MCIL_ERROR_PRINT(": Failed creating fake device fds");
+    return false;
+  }
+
+  MCIL_DEBUG_PRINT(": type[%d] format[%s]", type,
+                   FourccToString(v4l2_pixfmt).c_str());
+  return true;
+}
+
+int32_t FakeV4L2Device::Ioctl(int32_t request, void* arg) {
+  if (!ioctl_stats_)
+    return DispatchIoctl(request, arg);
+
+  MonotonicTime start = std::chrono::steady_clock::now();
+  int32_t ret = DispatchIoctl(request, arg);
+  int32_t error = (ret != 0) ? errno : 0;
+  ioctl_stats_->Record(request, error, start);
+  if (ret != 0)
+    errno = error;
+  return ret;
+}
+
+int32_t FakeV4L2Device::DispatchIoctl(int32_t request, void* arg) {
+  std::lock_guard<std::mutex> lock(lock_);
+
+  switch (static_cast<unsigned long>(static_cast<uint32_t>(request))) {
+    case VIDIOC_QUERYCAP:
+      return QueryCap(static_cast<struct v4l2_capability*>(arg));
+    case VIDIOC_ENUM_FMT:
+      return EnumFormat(static_cast<struct v4l2_fmtdesc*>(arg));
+    case VIDIOC_ENUM_FRAMESIZES:
+      return EnumFrameSizes(static_cast<struct v4l2_frmsizeenum*>(arg));
+    case VIDIOC_G_FMT:
+      return GetFormat(static_cast<struct v4l2_format*>(arg));
+    case VIDIOC_S_FMT:
+    case VIDIOC_TRY_FMT:
+      return SetFormat(static_cast<struct v4l2_format*>(arg));
+    case VIDIOC_REQBUFS:
+      return RequestBuffers(static_cast<struct v4l2_requestbuffers*>(arg));
+    case VIDIOC_QUERYBUF:
+      return QueryBuffer(static_cast<struct v4l2_buffer*>(arg));
+    case VIDIOC_QBUF:
+      return QueueBuffer(static_cast<struct v4l2_buffer*>(arg));
+    case VIDIOC_DQBUF:
+      return DequeueBuffer(static_cast<struct v4l2_buffer*>(arg));
+    case VIDIOC_STREAMON:
+      return StreamOn(static_cast<const int32_t*>(arg));
+    case VIDIOC_STREAMOFF:
+      return StreamOff(static_cast<const int32_t*>(arg));
+    case VIDIOC_EXPBUF: {
+      auto expbuf = static_cast<struct v4l2_exportbuffer*>(arg);
+      // There is no real memory behind the buffers, hand out a placeholder.
+      expbuf->fd = dup(device_fd_);
+      return (expbuf->fd < 0) ? Fail(errno) : 0;
+    }
+    case VIDIOC_SUBSCRIBE_EVENT:
+    case VIDIOC_UNSUBSCRIBE_EVENT: {
+      auto sub = static_cast<struct v4l2_event_subscription*>(arg);
+      if (sub->type != V4L2_EVENT_SOURCE_CHANGE)
+        return Fail(EINVAL);
+      events_subscribed_ = (static_cast<uint32_t>(request) ==
+                            static_cast<uint32_t>(VIDIOC_SUBSCRIBE_EVENT));
+      return 0;
+    }
+    case VIDIOC_DQEVENT:
+      return DequeueEvent(static_cast<struct v4l2_event*>(arg));
+    case VIDIOC_G_EXT_CTRLS:
+      return GetExtCtrls(static_cast<struct v4l2_ext_controls*>(arg));
+    case VIDIOC_S_EXT_CTRLS:
+      return SetExtCtrls(static_cast<struct v4l2_ext_controls*>(arg));
+    case VIDIOC_QUERYCTRL:
+      return QueryCtrl(static_cast<struct v4l2_queryctrl*>(arg));
+    case VIDIOC_QUERYMENU: {
+      auto query_menu = static_cast<struct v4l2_querymenu*>(arg);
+      if ((query_menu->id != V4L2_CID_MPEG_VIDEO_BITRATE_MODE) ||
+          (query_menu->index > V4L2_MPEG_VIDEO_BITRATE_MODE_CBR))
+        return Fail(EINVAL);
+      return 0;
+    }
+    case VIDIOC_G_SELECTION:
+      return GetSelection(static_cast<struct v4l2_selection*>(arg));
+    case VIDIOC_S_SELECTION:
+    case VIDIOC_S_CROP:
+    case VIDIOC_G_CROP:
+    case VIDIOC_S_PARM:
+      return 0;
+    case VIDIOC_TRY_DECODER_CMD:
+    case VIDIOC_TRY_ENCODER_CMD:
+      return IsDecoder() == (static_cast<uint32_t>(request) ==
+                             static_cast<uint32_t>(VIDIOC_TRY_DECODER_CMD))
+                 ? 0 : Fail(ENOTTY);
+    case VIDIOC_DECODER_CMD:
+      return Command(static_cast<struct v4l2_decoder_cmd*>(arg)->cmd);
+    case VIDIOC_ENCODER_CMD:
+      return Command(static_cast<struct v4l2_encoder_cmd*>(arg)->cmd);
+    default:
+      break;
+  }
+
+  MCIL_DEBUG_PRINT(": Unhandled request [0x%x]", request);
+  return Fail(ENOTTY);
+}
+
+bool FakeV4L2Device::Poll(bool poll_device, bool* event_pending) {
+  uint32_t ready_queues;
+  return Poll(poll_device, event_pending, &ready_queues);
+}
+
+bool FakeV4L2Device::Poll(bool poll_device, bool* event_pending,
+                          uint32_t* ready_queues) {
+  *event_pending = false;
+  *ready_queues = 0;
+
+  while (true) {
+    struct timespec timeout = {0, 0};
+    struct timespec* timeout_ptr = nullptr;
+    if (poll_device) {
+      std::lock_guard<std::mutex> lock(lock_);
+      Clock::time_point now = Clock::now();
+      Advance(now);
+      if (IsReady(event_pending, ready_queues))
+        return true;
+
+      Clock::time_point deadline;
+      if (NextDeadline(now, &deadline)) {
+        auto wait_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            deadline - now).count();
+        timeout.tv_sec = static_cast<time_t>(wait_ns / 1000000000);
+        timeout.tv_nsec = static_cast<long>(wait_ns % 1000000000);
+        timeout_ptr = &timeout;
+      }
+    }
+
+    struct pollfd pollfds[2];
+    nfds_t nfds = 1;
+    pollfds[0].fd = device_poll_interrupt_fd_;
+    pollfds[0].events = POLLIN | POLLERR;
+    pollfds[0].revents = 0;
+    if (poll_device) {
+      pollfds[nfds].fd = device_fd_;
+      pollfds[nfds].events = POLLIN;
+      pollfds[nfds].revents = 0;
+      nfds++;
+    }
+
+    if (HANDLE_EINTR(static_cast<int32_t>(
+            ppoll(pollfds, nfds, timeout_ptr, nullptr))) == -1) {
+      MCIL_ERROR_PRINT(": ppoll() failed");
+      return false;
+    }
+
+    if ((pollfds[0].revents & POLLIN) != 0) {
+      // Like poll(), also report what the device has ready at this point.
+      if (poll_device) {
+        std::lock_guard<std::mutex> lock(lock_);
+        IsReady(event_pending, ready_queues);
+      }
+      return true;
+    }
+
+    if ((nfds > 1) && ((pollfds[1].revents & POLLIN) != 0)) {
+      uint64_t buf;
+      HANDLE_EINTR(read(device_fd_, &buf, sizeof(buf)));
+    }
+  }
+}
+
+bool FakeV4L2Device::SetDevicePollInterrupt() {
+  // Already signalled and not cleared since, the poll wakes up anyway.
+  if (poll_interrupt_pending_.exchange(true, std::memory_order_acq_rel))
+    return true;
+
+  if (!WriteDevicePollInterrupt()) {
+    poll_interrupt_pending_.store(false, std::memory_order_release);
+    return false;
+  }
+  return true;
+}
+
+bool FakeV4L2Device::ClearDevicePollInterrupt() {
+  if (!poll_interrupt_pending_.exchange(false, std::memory_order_acq_rel))
+    return true;
+
+  uint64_t buf;
+  if ((HANDLE_EINTR(read(device_poll_interrupt_fd_, &buf, sizeof(buf))) ==
+       -1) && (errno != EAGAIN)) {
+    MCIL_ERROR_PRINT(": read() failed");
+    return false;
+  }
+
+  // Same as in GenericV4L2Device, signal again for a racing set.
+  if (poll_interrupt_pending_.load(std::memory_order_acquire))
+    return WriteDevicePollInterrupt();
+  return true;
+}
+
+bool FakeV4L2Device::WriteDevicePollInterrupt() {
+  const uint64_t buf = 1;
+  if (HANDLE_EINTR(write(device_poll_interrupt_fd_, &buf, sizeof(buf))) ==
+      -1) {
+    MCIL_ERROR_PRINT(": write() failed");
+    return false;
+  }
+  return true;
+}
+
+void* FakeV4L2Device::Mmap(void* addr, uint32_t len, int32_t prot,
+                           int32_t flags, uint32_t offset) {
+  std::lock_guard<std::mutex> lock(lock_);
+
+  uint32_t slot = offset >> 24;
+  uint32_t index = (offset >> 16) & 0xff;
+  uint32_t plane = (offset >> 12) & 0xf;
+  if ((slot >= kSlotCount) || (index >= queues_[slot].buffers.size()))
+    return MAP_FAILED;
+
+  auto& planes = queues_[slot].buffers[index].planes;
+  if ((plane >= planes.size()) || (len > planes[plane].size()))
+    return MAP_FAILED;
+
+  return planes[plane].data();
+}
+
+void FakeV4L2Device::Munmap(void* addr, uint32_t len) {
+  // Storage is owned by the buffers and released on REQBUFS(0).
+}
+
+std::vector<int32_t> FakeV4L2Device::GetDmabufsForV4L2Buffer(
+    int32_t index,
+    size_t num_planes,
+    enum v4l2_buf_type buffer_type) {
+  std::vector<int32_t> dmabuf_fds;
+  for (size_t i = 0; i < num_planes; ++i) {
+    struct v4l2_exportbuffer expbuf;
+    memset(&expbuf, 0, sizeof(expbuf));
+    expbuf.type = buffer_type;
+    expbuf.index = index;
+    expbuf.plane = static_cast<uint32_t>(i);
+    if (Ioctl(VIDIOC_EXPBUF, &expbuf) != 0) {
+      dmabuf_fds.clear();
+      break;
+    }
+    dmabuf_fds.push_back(expbuf.fd);
+  }
+  return dmabuf_fds;
+}
+
+bool FakeV4L2Device::CanCreateEGLImageFrom(const Fourcc fourcc) const {
+  switch (fourcc.ToV4L2PixFmt()) {
+    case V4L2_PIX_FMT_NV12:
+    case V4L2_PIX_FMT_NV12M:
+    case V4L2_PIX_FMT_YVU420:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
+uint32_t FakeV4L2Device::GetTextureTarget() const {
+  return GL_TEXTURE_EXTERNAL_OES;
+}
+
+SupportedProfiles FakeV4L2Device::GetSupportedDecodeProfiles() {
+  return EnumerateSupportedDecodeProfiles();
+}
+
+SupportedProfiles FakeV4L2Device::GetSupportedEncodeProfiles() {
+  return EnumerateSupportedEncodeProfiles();
+}
+
+void FakeV4L2Device::EnumerateDevicesForType(DeviceType type) {
+}
+
+std::vector<uint32_t>
+FakeV4L2Device::PreferredInputFormat(DeviceType type) const {
+  if (type == V4L2_ENCODER)
+    return { V4L2_PIX_FMT_YUV420, V4L2_PIX_FMT_NV12 };
+  return {};
+}
+
+// static
+int32_t FakeV4L2Device::SlotForType(uint32_t type) {
+  switch (type) {
+    case V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE:
+      return kOutputSlot;
+    case V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE:
+      return kCaptureSlot;
+    default:
+      break;
+  }
+  return -1;
+}
+
+int32_t FakeV4L2Device::QueryCap(struct v4l2_capability* caps) {
+  memset(caps, 0, sizeof(*caps));
+  snprintf(reinterpret_cast<char*>(caps->driver), sizeof(caps->driver),
+           "mcil-fake");
+  snprintf(reinterpret_cast<char*>(caps->card), sizeof(caps->card),
+           IsDecoder() ? "fake-decoder" : "fake-encoder");
+  caps->capabilities = V4L2_CAP_VIDEO_M2M_MPLANE | V4L2_CAP_STREAMING |
+                       V4L2_CAP_DEVICE_CAPS;
+  caps->device_caps = V4L2_CAP_VIDEO_M2M_MPLANE | V4L2_CAP_STREAMING;
+  return 0;
+}
+
+int32_t FakeV4L2Device::EnumFormat(struct v4l2_fmtdesc* fmtdesc) {
+  const auto formats = SupportedFormats(fmtdesc->type);
+  if (fmtdesc->index >= formats.size())
+    return Fail(EINVAL);
+
+  fmtdesc->pixelformat = formats[fmtdesc->index];
+  fmtdesc->flags = IsRawFormat(fmtdesc->pixelformat) ? 0
+                                                     : V4L2_FMT_FLAG_COMPRESSED;
+  snprintf(reinterpret_cast<char*>(fmtdesc->description),
+           sizeof(fmtdesc->description), "%s",
+           FourccToString(fmtdesc->pixelformat).c_str());
+  return 0;
+}
+
+int32_t FakeV4L2Device::EnumFrameSizes(struct v4l2_frmsizeenum* frame_size) {
+  if (frame_size->index != 0)
+    return Fail(EINVAL);
+
+  frame_size->type = V4L2_FRMSIZE_TYPE_STEPWISE;
+  frame_size->stepwise.min_width = kMinResolution;
+  frame_size->stepwise.min_height = kMinResolution;
+  frame_size->stepwise.max_width = kMaxWidth;
+  frame_size->stepwise.max_height = kMaxHeight;
+  frame_size->stepwise.step_width = 1;
+  frame_size->stepwise.step_height = 1;
+  return 0;
+}
+
+int32_t FakeV4L2Device::GetFormat(struct v4l2_format* format) {
+  int32_t slot = SlotForType(format->type);
+  if (slot < 0)
+    return Fail(EINVAL);
+
+  FakeQueue& queue = queues_[slot];
+  if (IsDecoder() && (slot == kCaptureSlot)) {
+    // Like real stateful decoders, the capture format is unknown until the
+    // stream header has been parsed.
+    if (!header_parsed_)
+      return Fail(EINVAL);
+    uint32_t pixelformat = queue.format_set
+        ? queue.format.fmt.pix_mp.pixelformat
+        : SupportedFormats(queue.type)[0];
+    FillRawFormat(&queue.format, pixelformat, config_.coded_size);
+    queue.format_set = true;
+  }
+
+  if (!queue.format_set)
+    return Fail(EINVAL);
+
+  *format = queue.format;
+  return 0;
+}
+
+int32_t FakeV4L2Device::SetFormat(struct v4l2_format* format) {
+  int32_t slot = SlotForType(format->type);
+  if (slot < 0)
+    return Fail(EINVAL);
+
+  FakeQueue& queue = queues_[slot];
+  if (!queue.buffers.empty())
+    return Fail(EBUSY);
+
+  const auto formats = SupportedFormats(format->type);
+  uint32_t pixelformat = format->fmt.pix_mp.pixelformat;
+  if (std::find(formats.begin(), formats.end(), pixelformat) ==
+      formats.end()) {
+    // Drivers adjust unsupported formats instead of failing.
+    pixelformat = formats[0];
+  }
+
+  Size size(format->fmt.pix_mp.width, format->fmt.pix_mp.height);
+  if (IsDecoder() && (slot == kCaptureSlot) && header_parsed_)
+    size = config_.coded_size;
+
+  if (IsRawFormat(pixelformat)) {
+    FillRawFormat(format, pixelformat, size);
+  } else {
+    v4l2_pix_format_mplane& pix_mp = format->fmt.pix_mp;
+    pix_mp.pixelformat = pixelformat;
+    pix_mp.num_planes = 1;
+    pix_mp.plane_fmt[0].bytesperline = 0;
+    if (pix_mp.plane_fmt[0].sizeimage == 0)
+      pix_mp.plane_fmt[0].sizeimage = kDefaultBitstreamBufferSize;
+  }
+
+  queue.format = *format;
+  queue.format_set = true;
+  return 0;
+}
+
+int32_t FakeV4L2Device::RequestBuffers(struct v4l2_requestbuffers* reqbufs) {
+  int32_t slot = SlotForType(reqbufs->type);
+  if (slot < 0)
+    return Fail(EINVAL);
+
+  FakeQueue& queue = queues_[slot];
+  if (queue.streaming)
+    return Fail(EBUSY);
+
+  switch (reqbufs->memory) {
+    case V4L2_MEMORY_MMAP:
+    case V4L2_MEMORY_USERPTR:
+    case V4L2_MEMORY_DMABUF:
+      break;
+    default:
+      return Fail(EINVAL);
+  }
+
+  queue.buffers.clear();
+  queue.pending.clear();
+  queue.done.clear();
+  if (reqbufs->count == 0)
+    return 0;
+
+  struct v4l2_format format;
+  memset(&format, 0, sizeof(format));
+  format.type = reqbufs->type;
+  if (GetFormat(&format) != 0)
+    return -1;
+
+  uint32_t count = std::min<uint32_t>(reqbufs->count, VIDEO_MAX_FRAME);
+  queue.memory = static_cast<enum v4l2_memory>(reqbufs->memory);
+  queue.buffers.resize(count);
+  if (queue.memory == V4L2_MEMORY_MMAP) {
+    for (auto& buffer : queue.buffers) {
+      buffer.planes.resize(format.fmt.pix_mp.num_planes);
+      for (size_t i = 0; i < buffer.planes.size(); ++i)
+        buffer.planes[i].resize(format.fmt.pix_mp.plane_fmt[i].sizeimage);
+    }
+  }
+
+  reqbufs->count = count;
+  return 0;
+}
+
+int32_t FakeV4L2Device::QueryBuffer(struct v4l2_buffer* buffer) {
+  int32_t slot = SlotForType(buffer->type);
+  if ((slot < 0) || (buffer->index >= queues_[slot].buffers.size()))
+    return Fail(EINVAL);
+
+  FakeQueue& queue = queues_[slot];
+  const v4l2_pix_format_mplane& pix_mp = queue.format.fmt.pix_mp;
+  if ((buffer->m.planes == nullptr) || (buffer->length < pix_mp.num_planes))
+    return Fail(EINVAL);
+
+  buffer->length = pix_mp.num_planes;
+  buffer->memory = queue.memory;
+  buffer->flags = queue.buffers[buffer->index].queued
+                      ? V4L2_BUF_FLAG_QUEUED : 0;
+  for (uint32_t i = 0; i < pix_mp.num_planes; ++i) {
+    buffer->m.planes[i].length = pix_mp.plane_fmt[i].sizeimage;
+    buffer->m.planes[i].bytesused = 0;
+    buffer->m.planes[i].data_offset = 0;
+    if (queue.memory == V4L2_MEMORY_MMAP)
+      buffer->m.planes[i].m.mem_offset =
+          MemOffset(static_cast<uint32_t>(slot), buffer->index, i);
+  }
+  return 0;
+}
+
+int32_t FakeV4L2Device::QueueBuffer(struct v4l2_buffer* buffer) {
+  int32_t slot = SlotForType(buffer->type);
+  if ((slot < 0) || (buffer->index >= queues_[slot].buffers.size()))
+    return Fail(EINVAL);
+
+  FakeQueue& queue = queues_[slot];
+  FakeBuffer& fake_buffer = queue.buffers[buffer->index];
+  if (fake_buffer.queued || (buffer->memory != queue.memory) ||
+      (buffer->m.planes == nullptr))
+    return Fail(EINVAL);
+
+  size_t num_planes = std::min<size_t>(buffer->length, VIDEO_MAX_PLANES);
+  for (size_t i = 0; i < num_planes; ++i)
+    fake_buffer.bytesused[i] = buffer->m.planes[i].bytesused;
+  fake_buffer.timestamp = buffer->timestamp;
+  fake_buffer.flags = 0;
+  fake_buffer.queued = true;
+  fake_buffer.queued_at = Clock::now();
+  queue.pending.push_back(buffer->index);
+
+  buffer->flags |= V4L2_BUF_FLAG_QUEUED;
+  KickDevice();
+  return 0;
+}
+
+int32_t FakeV4L2Device::DequeueBuffer(struct v4l2_buffer* buffer) {
+  int32_t slot = SlotForType(buffer->type);
+  if (slot < 0)
+    return Fail(EINVAL);
+
+  FakeQueue& queue = queues_[slot];
+  if (!queue.streaming)
+    return Fail(EINVAL);
+
+  Advance(Clock::now());
+  if (queue.done.empty()) {
+    if ((slot == kCaptureSlot) && last_sent_)
+      return Fail(EPIPE);
+    return Fail(EAGAIN);
+  }
+
+  uint32_t index = queue.done.front();
+  queue.done.pop_front();
+
+  const FakeBuffer& fake_buffer = queue.buffers[index];
+  const v4l2_pix_format_mplane& pix_mp = queue.format.fmt.pix_mp;
+  buffer->index = index;
+  buffer->flags = fake_buffer.flags;
+  buffer->timestamp = fake_buffer.timestamp;
+  buffer->memory = queue.memory;
+  buffer->field = V4L2_FIELD_NONE;
+  if (buffer->m.planes != nullptr) {
+    uint32_t num_planes = std::min<uint32_t>(buffer->length,
+                                             pix_mp.num_planes);
+    for (uint32_t i = 0; i < num_planes; ++i) {
+      buffer->m.planes[i].bytesused = fake_buffer.bytesused[i];
+      buffer->m.planes[i].length = pix_mp.plane_fmt[i].sizeimage;
+      buffer->m.planes[i].data_offset = 0;
+      if (queue.memory == V4L2_MEMORY_MMAP)
+        buffer->m.planes[i].m.mem_offset =
+            MemOffset(static_cast<uint32_t>(slot), index, i);
+    }
+    buffer->length = num_planes;
+  }
+  return 0;
+}
+
+int32_t FakeV4L2Device::StreamOn(const int32_t* type) {
+  int32_t slot = SlotForType(static_cast<uint32_t>(*type));
+  if ((slot < 0) || queues_[slot].buffers.empty())
+    return Fail(EINVAL);
+
+  queues_[slot].streaming = true;
+  if (slot == kCaptureSlot)
+    last_sent_ = false;
+
+  KickDevice();
+  return 0;
+}
+
+int32_t FakeV4L2Device::StreamOff(const int32_t* type) {
+  int32_t slot = SlotForType(static_cast<uint32_t>(*type));
+  if (slot < 0)
+    return Fail(EINVAL);
+
+  FakeQueue& queue = queues_[slot];
+  queue.streaming = false;
+  queue.pending.clear();
+  queue.done.clear();
+  for (auto& buffer : queue.buffers)
+    buffer.queued = false;
+
+  if (slot == kOutputSlot) {
+    job_running_ = false;
+    drain_pending_ = false;
+  } else {
+    last_sent_ = false;
+  }
+  return 0;
+}
+
+int32_t FakeV4L2Device::DequeueEvent(struct v4l2_event* event) {
+  if (events_.empty())
+    return Fail(ENOENT);
+
+  *event = events_.front();
+  events_.pop_front();
+  event->pending = static_cast<uint32_t>(events_.size());
+  return 0;
+}
+
+int32_t FakeV4L2Device::GetExtCtrls(struct v4l2_ext_controls* ext_ctrls) {
+  for (uint32_t i = 0; i < ext_ctrls->count; ++i) {
+    struct v4l2_ext_control& ctrl = ext_ctrls->controls[i];
+    if (ctrl.id != V4L2_CID_MIN_BUFFERS_FOR_CAPTURE) {
+      ext_ctrls->error_idx = i;
+      return Fail(EINVAL);
+    }
+    ctrl.value = static_cast<int32_t>(config_.min_capture_buffers);
+  }
+  return 0;
+}
+
+int32_t FakeV4L2Device::SetExtCtrls(struct v4l2_ext_controls* ext_ctrls) {
+  for (uint32_t i = 0; i < ext_ctrls->count; ++i) {
+    if (ext_ctrls->controls[i].id == V4L2_CID_MPEG_VIDEO_FORCE_KEY_FRAME)
+      force_keyframe_ = true;
+  }
+  return 0;
+}
+
+int32_t FakeV4L2Device::QueryCtrl(struct v4l2_queryctrl* query_ctrl) {
+  if (query_ctrl->id != V4L2_CID_MPEG_VIDEO_BITRATE_MODE)
+    return Fail(EINVAL);
+
+  query_ctrl->type = V4L2_CTRL_TYPE_MENU;
+  query_ctrl->minimum = V4L2_MPEG_VIDEO_BITRATE_MODE_VBR;
+  query_ctrl->maximum = V4L2_MPEG_VIDEO_BITRATE_MODE_CBR;
+  query_ctrl->default_value = V4L2_MPEG_VIDEO_BITRATE_MODE_VBR;
+  return 0;
+}
+
+int32_t FakeV4L2Device::GetSelection(struct v4l2_selection* selection) {
+  if (IsDecoder() && !header_parsed_)
+    return Fail(EINVAL);
+
+  const Size& size = IsDecoder()
+      ? config_.coded_size
+      : Size(queues_[kOutputSlot].format.fmt.pix_mp.width,
+             queues_[kOutputSlot].format.fmt.pix_mp.height);
+  selection->r.left = 0;
+  selection->r.top = 0;
+  selection->r.width = size.width;
+  selection->r.height = size.height;
+  return 0;
+}
+
+int32_t FakeV4L2Device::Command(uint32_t cmd) {
+  // V4L2_ENC_CMD_STOP/START share the values of the decoder commands.
+  switch (cmd) {
+    case V4L2_DEC_CMD_STOP:
+      drain_pending_ = true;
+      break;
+    case V4L2_DEC_CMD_START:
+      drain_pending_ = false;
+      last_sent_ = false;
+      break;
+    default:
+      return Fail(EINVAL);
+  }
+
+  KickDevice();
+  return 0;
+}
+
+void FakeV4L2Device::FillRawFormat(struct v4l2_format* format,
+                                   uint32_t pixelformat,
+                                   const Size& size) {
+  const Size coded_size(Align(std::max(size.width, kMinResolution),
+                              kCodedAlignment),
+                        Align(std::max(size.height, kMinResolution),
+                              kCodedAlignment));
+  const VideoPixelFormat video_format =
+      Fourcc::FromV4L2PixFmt(pixelformat)->ToVideoPixelFormat();
+  const size_t num_planes = GetNumPlanesOfV4L2PixFmt(pixelformat);
+
+  v4l2_pix_format_mplane& pix_mp = format->fmt.pix_mp;
+  pix_mp.pixelformat = pixelformat;
+  pix_mp.width = coded_size.width;
+  pix_mp.height = coded_size.height;
+  pix_mp.field = V4L2_FIELD_NONE;
+  pix_mp.num_planes = static_cast<uint8_t>(num_planes);
+  if (num_planes == 1) {
+    pix_mp.plane_fmt[0].bytesperline =
+        VideoFrame::PlaneSize(video_format, 0, coded_size).width;
+    pix_mp.plane_fmt[0].sizeimage = static_cast<uint32_t>(
+        VideoFrame::AllocationSize(video_format, coded_size));
+    return;
+  }
+
+  for (size_t i = 0; i < num_planes; ++i) {
+    const Size plane_size = VideoFrame::PlaneSize(video_format, i, coded_size);
+    pix_mp.plane_fmt[i].bytesperline = plane_size.width;
+    pix_mp.plane_fmt[i].sizeimage = plane_size.GetArea();
+  }
+}
+
+std::vector<uint32_t> FakeV4L2Device::SupportedFormats(uint32_t type) const {
+  const bool coded_queue =
+      (type == V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE) == (type_ != V4L2_ENCODER);
+  if (type_ == V4L2_ENCODER) {
+    if (coded_queue)
+      return { V4L2_PIX_FMT_H264, V4L2_PIX_FMT_VP8 };
+    return { V4L2_PIX_FMT_YUV420, V4L2_PIX_FMT_NV12 };
+  }
+
+  if (coded_queue)
+    return { V4L2_PIX_FMT_H264, V4L2_PIX_FMT_VP8, V4L2_PIX_FMT_VP9 };
+  return { V4L2_PIX_FMT_NV12 };
+}
+
+void FakeV4L2Device::Advance(Clock::time_point now) {
+  FakeQueue& input = queues_[kOutputSlot];
+  FakeQueue& output = queues_[kCaptureSlot];
+
+  while (true) {
+    if (!job_running_) {
+      if (!input.streaming || input.pending.empty())
+        break;
+
+      current_job_.index = input.pending.front();
+      input.pending.pop_front();
+
+      uint32_t latency_us = 0;
+      if (!config_.latencies_us.empty()) {
+        latency_us =
+            config_.latencies_us[jobs_started_ % config_.latencies_us.size()];
+      }
+      jobs_started_++;
+
+      Clock::time_point start =
+          std::max(engine_free_at_, input.buffers[current_job_.index].queued_at);
+      current_job_.done_at = start + std::chrono::microseconds(latency_us);
+      job_running_ = true;
+    }
+
+    if (current_job_.done_at > now)
+      break;
+
+    if (IsDecoder() && !header_parsed_) {
+      // The first buffer carries the stream header. Report the coded size and
+      // hold the job until the client has set up the capture queue.
+      header_parsed_ = true;
+      if (events_subscribed_) {
+        struct v4l2_event event;
+        memset(&event, 0, sizeof(event));
+        event.type = V4L2_EVENT_SOURCE_CHANGE;
+        event.u.src_change.changes = V4L2_EVENT_SRC_CH_RESOLUTION;
+        events_.push_back(event);
+      }
+    }
+
+    if (!output.streaming || output.pending.empty())
+      break;
+
+    engine_free_at_ = std::max(
+        current_job_.done_at, output.buffers[output.pending.front()].queued_at);
+    CompleteJob(current_job_);
+    job_running_ = false;
+  }
+
+  if (drain_pending_ && !job_running_ && input.pending.empty() &&
+      output.streaming && !output.pending.empty()) {
+    uint32_t index = output.pending.front();
+    output.pending.pop_front();
+
+    FakeBuffer& buffer = output.buffers[index];
+    memset(buffer.bytesused, 0, sizeof(buffer.bytesused));
+    buffer.flags = V4L2_BUF_FLAG_LAST;
+    buffer.queued = false;
+    output.done.push_back(index);
+
+    drain_pending_ = false;
+    last_sent_ = true;
+  }
+}
+
+void FakeV4L2Device::CompleteJob(const Job& job) {
+  FakeQueue& input = queues_[kOutputSlot];
+  FakeQueue& output = queues_[kCaptureSlot];
+
+  FakeBuffer& input_buffer = input.buffers[job.index];
+  input_buffer.queued = false;
+  input.done.push_back(job.index);
+
+  uint32_t index = output.pending.front();
+  output.pending.pop_front();
+
+  FakeBuffer& output_buffer = output.buffers[index];
+  const v4l2_pix_format_mplane& pix_mp = output.format.fmt.pix_mp;
+  output_buffer.timestamp = input_buffer.timestamp;
+  output_buffer.flags = 0;
+  output_buffer.queued = false;
+  memset(output_buffer.bytesused, 0, sizeof(output_buffer.bytesused));
+
+  if (IsDecoder()) {
+    for (uint32_t i = 0; i < pix_mp.num_planes; ++i)
+      output_buffer.bytesused[i] = pix_mp.plane_fmt[i].sizeimage;
+  } else {
+    size_t bitstream_bytes = config_.bitstream_bytes
+        ? config_.bitstream_bytes : (pix_mp.plane_fmt[0].sizeimage / 8);
+    output_buffer.bytesused[0] = static_cast<uint32_t>(
+        std::min<size_t>(bitstream_bytes, pix_mp.plane_fmt[0].sizeimage));
+    if (force_keyframe_ || (jobs_started_ == 1))
+      output_buffer.flags |= V4L2_BUF_FLAG_KEYFRAME;
+    force_keyframe_ = false;
+  }
+
+  output.done.push_back(index);
+}
+
+bool FakeV4L2Device::IsReady(bool* event_pending,
+                             uint32_t* ready_queues) const {
+  *event_pending = !events_.empty();
+  *ready_queues = 0;
+  if (!queues_[kOutputSlot].done.empty())
+    *ready_queues |= kOutputQueueReady;
+  if (!queues_[kCaptureSlot].done.empty())
+    *ready_queues |= kCaptureQueueReady;
+  return *event_pending || (*ready_queues != 0);
+}
+
+bool FakeV4L2Device::NextDeadline(Clock::time_point now,
+                                  Clock::time_point* deadline) const {
+  // A job that is already due waits for a capture buffer, not for time.
+  if (!job_running_ || (current_job_.done_at <= now))
+    return false;
+
+  *deadline = current_job_.done_at;
+  return true;
+}
+
+void FakeV4L2Device::KickDevice() {
+  const uint64_t buf = 1;
+  if (device_fd_ != -1)
+    HANDLE_EINTR(write(device_fd_, &buf, sizeof(buf)));
+}
+
+}  // namespace mcil
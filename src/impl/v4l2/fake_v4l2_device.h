@@ -0,0 +1,179 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef SRC_IMPL_V4L2_FAKE_V4L2_DEVICE_H_
+#define SRC_IMPL_V4L2_FAKE_V4L2_DEVICE_H_
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+
+#include "v4l2/v4l2_device.h"
+
+namespace mcil {
+
+// Userspace emulation of a stateful V4L2 memory-to-memory codec. It lets
+// V4L2VideoDecoder and V4L2VideoEncoder run on a host without hardware so
+// the library overhead (queue bookkeeping, poll thread handoff) can be
+// measured. Every input buffer is "processed" after a scripted latency and
+// produces exactly one capture buffer. Selected with USE_V4L2_DEVICE=FAKE
+// when built with ENABLE_FAKE_V4L2_DEVICE.
+class FakeV4L2Device : public V4L2Device {
+ public:
+  struct Config {
+    // Coded size reported by the decoder after the first input buffer.
+    Size coded_size = Size(1920, 1080);
+    // Value returned for V4L2_CID_MIN_BUFFERS_FOR_CAPTURE.
+    uint32_t min_capture_buffers = 4;
+    // Per input buffer processing time in microseconds, used round robin.
+    std::vector<uint32_t> latencies_us;
+    // Encoded bytes per frame. 0 means an eighth of the capture buffer.
+    size_t bitstream_bytes = 0;
+  };
+
+  // Configuration used by devices created afterwards. The default is read
+  // from FAKE_V4L2_LATENCY_US ("500,800,...") and FAKE_V4L2_CODED_SIZE
+  // ("1920x1080").
+  static void SetConfig(const Config& config);
+  static Config GetConfig();
+
+  FakeV4L2Device(DeviceType device_type);
+
+  FakeV4L2Device(const FakeV4L2Device&) = delete;
+  FakeV4L2Device& operator=(const FakeV4L2Device&) = delete;
+
+  // V4L2Device implementation.
+  virtual bool Open(DeviceType type, uint32_t v4l2_pixfmt) override;
+  virtual int32_t Ioctl(int32_t request, void* arg) override;
+  virtual bool Poll(bool poll_device, bool* event_pending) override;
+  virtual bool Poll(bool poll_device, bool* event_pending,
+                    uint32_t* ready_queues) override;
+  virtual bool SetDevicePollInterrupt() override;
+  virtual bool ClearDevicePollInterrupt() override;
+  virtual void* Mmap(void* addr, uint32_t len, int32_t prot, int32_t flags,
+                     uint32_t offset) override;
+  virtual void Munmap(void* addr, uint32_t len) override;
+
+  virtual std::vector<int32_t> GetDmabufsForV4L2Buffer(
+      int32_t index, size_t num_planes, enum v4l2_buf_type buffer_type)
+      override;
+
+  virtual bool CanCreateEGLImageFrom(const Fourcc fourcc) const override;
+  virtual uint32_t GetTextureTarget() const override;
+
+  virtual SupportedProfiles GetSupportedDecodeProfiles() override;
+  virtual SupportedProfiles GetSupportedEncodeProfiles() override;
+  virtual void EnumerateDevicesForType(DeviceType type) override;
+  virtual std::vector<uint32_t> PreferredInputFormat(DeviceType type)
+      const override;
+
+ protected:
+  virtual ~FakeV4L2Device() noexcept(false);
+  virtual bool Initialize() override;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  enum { kOutputSlot = 0, kCaptureSlot = 1, kSlotCount = 2 };
+
+  struct FakeBuffer {
+    std::vector<std::vector<uint8_t>> planes;
+    uint32_t bytesused[VIDEO_MAX_PLANES] = {};
+    uint32_t flags = 0;
+    struct timeval timestamp = {0, 0};
+    bool queued = false;
+    Clock::time_point queued_at;
+  };
+
+  struct FakeQueue {
+    enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
+    enum v4l2_memory memory = V4L2_MEMORY_MMAP;
+    struct v4l2_format format;
+    bool format_set = false;
+    bool streaming = false;
+    std::vector<FakeBuffer> buffers;
+    // Indices in the order they were queued and completed respectively.
+    std::deque<uint32_t> pending;
+    std::deque<uint32_t> done;
+  };
+
+  struct Job {
+    uint32_t index = 0;
+    Clock::time_point done_at;
+  };
+
+  static int32_t SlotForType(uint32_t type);
+
+  int32_t DispatchIoctl(int32_t request, void* arg);
+
+  int32_t QueryCap(struct v4l2_capability* caps);
+  int32_t EnumFormat(struct v4l2_fmtdesc* fmtdesc);
+  int32_t EnumFrameSizes(struct v4l2_frmsizeenum* frame_size);
+  int32_t GetFormat(struct v4l2_format* format);
+  int32_t SetFormat(struct v4l2_format* format);
+  int32_t RequestBuffers(struct v4l2_requestbuffers* reqbufs);
+  int32_t QueryBuffer(struct v4l2_buffer* buffer);
+  int32_t QueueBuffer(struct v4l2_buffer* buffer);
+  int32_t DequeueBuffer(struct v4l2_buffer* buffer);
+  int32_t StreamOn(const int32_t* type);
+  int32_t StreamOff(const int32_t* type);
+  int32_t DequeueEvent(struct v4l2_event* event);
+  int32_t GetExtCtrls(struct v4l2_ext_controls* ext_ctrls);
+  int32_t SetExtCtrls(struct v4l2_ext_controls* ext_ctrls);
+  int32_t QueryCtrl(struct v4l2_queryctrl* query_ctrl);
+  int32_t GetSelection(struct v4l2_selection* selection);
+  int32_t Command(uint32_t cmd);
+
+  void FillRawFormat(struct v4l2_format* format, uint32_t pixelformat,
+                     const Size& size);
+  std::vector<uint32_t> SupportedFormats(uint32_t type) const;
+
+  // Moves the emulated hardware forward to |now|. Completes every job that
+  // is due and has a capture buffer to land in.
+  void Advance(Clock::time_point now);
+  void CompleteJob(const Job& job);
+  bool IsReady(bool* event_pending, uint32_t* ready_queues) const;
+  bool NextDeadline(Clock::time_point now, Clock::time_point* deadline) const;
+  void KickDevice();
+  bool WriteDevicePollInterrupt();
+
+  Config config_;
+  DeviceType type_;
+
+  mutable std::mutex lock_;
+  FakeQueue queues_[kSlotCount] GUARDED_BY(lock_);
+  Job current_job_ GUARDED_BY(lock_);
+  bool job_running_ GUARDED_BY(lock_) = false;
+  Clock::time_point engine_free_at_ GUARDED_BY(lock_);
+  size_t jobs_started_ GUARDED_BY(lock_) = 0;
+  std::deque<struct v4l2_event> events_ GUARDED_BY(lock_);
+  bool header_parsed_ GUARDED_BY(lock_) = false;
+  bool drain_pending_ GUARDED_BY(lock_) = false;
+  bool last_sent_ GUARDED_BY(lock_) = false;
+  bool force_keyframe_ GUARDED_BY(lock_) = false;
+  bool events_subscribed_ GUARDED_BY(lock_) = false;
+
+  // Readable whenever the emulated device state changed, so a blocked
+  // Poll() can recompute its deadline.
+  int32_t device_fd_ = -1;
+  int32_t device_poll_interrupt_fd_ = -1;
+  // Same as in GenericV4L2Device.
+  std::atomic<bool> poll_interrupt_pending_{false};
+};
+
+}  // namespace mcil
+
+#endif  // SRC_IMPL_V4L2_FAKE_V4L2_DEVICE_H_
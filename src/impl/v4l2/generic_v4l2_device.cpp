@@ -4,7 +4,15 @@
 
 #include "generic_v4l2_device.h"
 
+#if defined(MCIL_WITHOUT_LIBDRM)
+// Host builds without libdrm (e.g. benchmark). Same codes as drm_fourcc.h.
+#define DRM_FORMAT_ARGB8888 v4l2_fourcc('A', 'R', '2', '4')
+#define DRM_FORMAT_NV12 v4l2_fourcc('N', 'V', '1', '2')
+#define DRM_FORMAT_YUV420 v4l2_fourcc('Y', 'U', '1', '2')
+#define DRM_FORMAT_YVU420 v4l2_fourcc('Y', 'V', '1', '2')
+#else
 #include <libdrm/drm_fourcc.h>
+#endif
 #include <poll.h>
 #include <cstring>
 #include <sys/eventfd.h>
@@ -92,10 +100,26 @@ int32_t GenericV4L2Device::Ioctl(int32_t request, void* arg) {
     return 0;
   }
 
-  return HANDLE_EINTR(static_cast<int32_t>(ioctl(device_fd_, request, arg)));
+  if (!ioctl_stats_)
+    return HANDLE_EINTR(static_cast<int32_t>(ioctl(device_fd_, request, arg)));
+
+  MonotonicTime start = std::chrono::steady_clock::now();
+  int32_t ret =
+      HANDLE_EINTR(static_cast<int32_t>(ioctl(device_fd_, request, arg)));
+  int32_t error = (ret != 0) ? errno : 0;
+  ioctl_stats_->Record(request, error, start);
+  if (ret != 0)
+    errno = error;
+  return ret;
 }
 
 bool GenericV4L2Device::Poll(bool poll_device, bool* event_pending) {
+  uint32_t ready_queues;
+  return Poll(poll_device, event_pending, &ready_queues);
+}
+
+bool GenericV4L2Device::Poll(bool poll_device, bool* event_pending,
+                             uint32_t* ready_queues) {
   struct pollfd pollfds[2];
   nfds_t nfds;
   int32_t poll_fd = -1;
@@ -120,33 +144,65 @@ bool GenericV4L2Device::Poll(bool poll_device, bool* event_pending) {
 
   *event_pending =
       ((poll_fd >= 0) && ((pollfds[poll_fd].revents & POLLPRI) != 0));
+  *ready_queues = 0;
+  if (poll_fd >= 0) {
+    *ready_queues = PollEventsToReadyQueues(
+        static_cast<uint16_t>(pollfds[poll_fd].revents));
+  }
   return true;
 }
 
 bool GenericV4L2Device::SetDevicePollInterrupt() {
-  const uint64_t buf = 1;
-  if (HANDLE_EINTR(write(device_poll_interrupt_fd_, &buf, sizeof(buf))) ==
-      -1) {
-    MCIL_ERROR_PRINT(": write() failed");
+  // Already signalled and not cleared since, the poll wakes up anyway.
+  if (poll_interrupt_pending_.exchange(true, std::memory_order_acq_rel))
+    return true;
+
+  if (!WriteDevicePollInterrupt()) {
+    poll_interrupt_pending_.store(false, std::memory_order_release);
     return false;
   }
   return true;
 }
 
 bool GenericV4L2Device::ClearDevicePollInterrupt() {
+  if (!poll_interrupt_pending_.exchange(false, std::memory_order_acq_rel))
+    return true;
+
   uint64_t buf;
-  if (HANDLE_EINTR(read(device_poll_interrupt_fd_, &buf, sizeof(buf))) ==
+  if ((HANDLE_EINTR(read(device_poll_interrupt_fd_, &buf, sizeof(buf))) ==
+       -1) && (errno != EAGAIN)) {
+    MCIL_ERROR_PRINT(": read() failed");
+    return false;
+  }
+
+  // A SetDevicePollInterrupt() since the exchange above may have had its
+  // write drained by this read. Signal again for it, or its poll would
+  // never wake up.
+  if (poll_interrupt_pending_.load(std::memory_order_acquire))
+    return WriteDevicePollInterrupt();
+  return true;
+}
+
+bool GenericV4L2Device::WriteDevicePollInterrupt() {
+  const uint64_t buf = 1;
+  if (HANDLE_EINTR(write(device_poll_interrupt_fd_, &buf, sizeof(buf))) ==
       -1) {
-    if (errno == EAGAIN) {
-      return true;
-    } else {
-      MCIL_ERROR_PRINT(": read() failed");
-      return false;
-    }
+    MCIL_ERROR_PRINT(": write() failed");
+    return false;
   }
   return true;
 }
 
+bool GenericV4L2Device::GetPollFds(int32_t* device_fd,
+                                   int32_t* interrupt_fd) const {
+  if ((device_fd_ == -1) || (device_poll_interrupt_fd_ == -1))
+    return false;
+
+  *device_fd = device_fd_;
+  *interrupt_fd = device_poll_interrupt_fd_;
+  return true;
+}
+
 void* GenericV4L2Device::Mmap(void* addr, uint32_t len, int32_t prot,
                               int32_t flags, uint32_t offset) {
   return mmap(addr, len, prot, flags, device_fd_, offset);
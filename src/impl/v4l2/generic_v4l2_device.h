@@ -8,6 +8,8 @@
 #ifndef SRC_IMPL_V4L2_GENERIC_V4L2_DEVICE_H_
 #define SRC_IMPL_V4L2_GENERIC_V4L2_DEVICE_H_
 
+#include <atomic>
+
 #include "v4l2/v4l2_device.h"
 
 namespace mcil {
@@ -23,8 +25,12 @@ class GenericV4L2Device : public V4L2Device {
   virtual bool Open(DeviceType type, uint32_t v4l2_pixfmt) override;
   virtual int32_t Ioctl(int32_t request, void* arg) override;
   virtual bool Poll(bool poll_device, bool* event_pending) override;
+  virtual bool Poll(bool poll_device, bool* event_pending,
+                    uint32_t* ready_queues) override;
   virtual bool SetDevicePollInterrupt() override;
   virtual bool ClearDevicePollInterrupt() override;
+  virtual bool GetPollFds(int32_t* device_fd,
+                          int32_t* interrupt_fd) const override;
   virtual void* Mmap(void* addr, uint32_t len, int32_t prot, int32_t flags,
                      uint32_t offset) override;
   virtual void Munmap(void* addr, uint32_t len) override;
@@ -48,6 +54,7 @@ class GenericV4L2Device : public V4L2Device {
 
   bool OpenDevice(const std::string& path, DeviceType type);
   void CloseDevice();
+  bool WriteDevicePollInterrupt();
 
   std::string GetDevicePathFor(DeviceType type, uint32_t pixfmt);
   const Devices& GetDevicesForType(DeviceType type);
@@ -56,6 +63,10 @@ class GenericV4L2Device : public V4L2Device {
   int32_t device_fd_ = -1;
 
   int32_t device_poll_interrupt_fd_ = -1;
+  // Set while |device_poll_interrupt_fd_| is signalled, so redundant
+  // writes and reads are skipped. Whenever it is set, a write to the fd is
+  // done or on its way, see ClearDevicePollInterrupt().
+  std::atomic<bool> poll_interrupt_pending_{false};
 
   enum v4l2_buf_type buffer_type_ = V4L2_BUF_TYPE_VIDEO_CAPTURE;
 
@@ -4,6 +4,7 @@
 
 #include "v4l2_buffers.h"
 
+#include <algorithm>
 #include <memory>
 #include <cstring>
 #include <sys/mman.h>
@@ -161,42 +162,163 @@ scoped_refptr<VideoFrame> V4L2Buffer::CreateVideoFrame() {
 }
 
 /* V4L2BuffersList */
+static_assert(VIDEO_MAX_FRAME <= V4L2BuffersList::kMaxBuffers,
+              "V4L2BuffersList cannot hold VIDEO_MAX_FRAME buffers");
+
 void V4L2BuffersList::ReturnBuffer(size_t buffer_id) {
-  std::lock_guard<std::mutex> lock(lock_);
-  free_buffers_.emplace(buffer_id);
+  if (buffer_id >= kMaxBuffers) {
+    MCIL_ERROR_PRINT(": Invalid buffer_id [%zu]", buffer_id);
+    return;
+  }
+
+  free_buffers_.fetch_or(uint64_t(1) << buffer_id, std::memory_order_release);
 }
 
 Optional<size_t> V4L2BuffersList::GetFreeBuffer() {
-  std::lock_guard<std::mutex> lock(lock_);
+  uint64_t free_buffers = free_buffers_.load(std::memory_order_acquire);
+  uint64_t lowest;
+  do {
+    if (free_buffers == 0)
+      return nullopt;
 
-  auto iter = free_buffers_.begin();
-  if (iter == free_buffers_.end()) {
-    return nullopt;
-  }
+    lowest = free_buffers & (~free_buffers + 1);
+  } while (!free_buffers_.compare_exchange_weak(free_buffers,
+                                                free_buffers & ~lowest,
+                                                std::memory_order_acquire));
+
+  return static_cast<size_t>(__builtin_ctzll(lowest));
+}
 
-  size_t buffer_id = *iter;
-  free_buffers_.erase(iter);
-  return buffer_id;
+bool V4L2BuffersList::GetFreeBuffer(size_t buffer_id) {
+  if (buffer_id >= kMaxBuffers)
+    return false;
+
+  uint64_t bit = uint64_t(1) << buffer_id;
+  return (free_buffers_.fetch_and(~bit, std::memory_order_acquire) & bit) != 0;
 }
 
 size_t V4L2BuffersList::GetSize() const {
+  return static_cast<size_t>(
+      __builtin_popcountll(free_buffers_.load(std::memory_order_relaxed)));
+}
+
+/* V4L2BufferRefPool */
+// static
+V4L2BufferRefPool* V4L2BufferRefPool::Create() {
+  return new V4L2BufferRefPool();
+}
+
+V4L2BufferRefPool::~V4L2BufferRefPool() {
+  for (auto& free_list : free_lists_) {
+    while (free_list.head != nullptr) {
+      Slot* slot = free_list.head;
+      free_list.head = slot->next;
+      ::operator delete(slot);
+    }
+  }
+}
+
+void* V4L2BufferRefPool::Allocate(size_t size) {
+  Slot* slot = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    for (auto& free_list : free_lists_) {
+      if (free_list.size == size && free_list.head != nullptr) {
+        slot = free_list.head;
+        free_list.head = slot->next;
+        break;
+      }
+    }
+    allocated_slots_++;
+  }
+
+  if (slot == nullptr) {
+    slot = static_cast<Slot*>(::operator new(kSlotHeaderSize + size));
+    slot->pool = this;
+    slot->size = size;
+  }
+
+  slot->next = nullptr;
+  return reinterpret_cast<char*>(slot) + kSlotHeaderSize;
+}
+
+// static
+void V4L2BufferRefPool::Free(void* ptr) {
+  if (ptr == nullptr)
+    return;
+
+  Slot* slot = reinterpret_cast<Slot*>(
+      static_cast<char*>(ptr) - kSlotHeaderSize);
+  V4L2BufferRefPool* pool = slot->pool;
+  if (pool->Recycle(slot))
+    delete pool;
+}
+
+void V4L2BufferRefPool::Destroy() {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    destroyed_ = true;
+    if (allocated_slots_ != 0)
+      return;
+  }
+  delete this;
+}
+
+bool V4L2BufferRefPool::Recycle(Slot* slot) {
   std::lock_guard<std::mutex> lock(lock_);
-  return free_buffers_.size();
+  allocated_slots_--;
+  if (!destroyed_) {
+    for (auto& free_list : free_lists_) {
+      if (free_list.size == 0)
+        free_list.size = slot->size;
+      if (free_list.size == slot->size) {
+        slot->next = free_list.head;
+        free_list.head = slot;
+        return false;
+      }
+    }
+  }
+
+  ::operator delete(slot);
+  return destroyed_ && (allocated_slots_ == 0);
 }
 
 /* V4L2BufferRefBase */
+// static
+std::unique_ptr<V4L2BufferRefBase> V4L2BufferRefBase::Create(
+    const struct v4l2_buffer& buffer, V4L2Queue* queue) {
+  return std::unique_ptr<V4L2BufferRefBase>(
+      new (queue->ref_pool_) V4L2BufferRefBase(buffer, queue));
+}
+
 V4L2BufferRefBase::V4L2BufferRefBase(const struct v4l2_buffer& buffer,
                                      V4L2Queue* queue)
   : queue_(std::move(queue)), return_to_(queue_->free_buffers_) {
-  memset(&buffer_, 0, sizeof(buffer_));
-  memset(v4l2_planes_, 0, sizeof(v4l2_planes_));
-
   memcpy(&buffer_, &buffer, sizeof(buffer_));
+
+  // Only the planes in use are copied, the rest is cleared.
+  size_t planes_count = std::min(static_cast<size_t>(buffer.length),
+                                 ARRAY_SIZE(v4l2_planes_));
   memcpy(v4l2_planes_, buffer.m.planes,
-         sizeof(struct v4l2_plane) * buffer.length);
+         sizeof(struct v4l2_plane) * planes_count);
+  memset(v4l2_planes_ + planes_count, 0,
+         sizeof(struct v4l2_plane) * (ARRAY_SIZE(v4l2_planes_) - planes_count));
   buffer_.m.planes = v4l2_planes_;
 }
 
+void* V4L2BufferRefBase::operator new(size_t size, V4L2BufferRefPool* pool) {
+  return pool->Allocate(size);
+}
+
+void V4L2BufferRefBase::operator delete(void* ptr,
+                                        V4L2BufferRefPool* /* pool */) {
+  V4L2BufferRefPool::Free(ptr);
+}
+
+void V4L2BufferRefBase::operator delete(void* ptr) {
+  V4L2BufferRefPool::Free(ptr);
+}
+
 V4L2BufferRefBase::~V4L2BufferRefBase() noexcept(false) {
   if (!queued_)
     return_to_->ReturnBuffer(BufferIndex());
@@ -242,11 +364,23 @@ void V4L2BufferRefBase::SetBufferPTS(int64_t timestamp) {
 V4L2ReadableBuffer::V4L2ReadableBuffer(const struct v4l2_buffer& buffer,
                                        V4L2Queue* queue,
                                        scoped_refptr<VideoFrame> video_frame)
-  : buffer_data_(
-        std::make_unique<V4L2BufferRefBase>(buffer, std::move(queue))),
+  : buffer_data_(V4L2BufferRefBase::Create(buffer, queue)),
     video_frame_(std::move(video_frame)) {
 }
 
+void* V4L2ReadableBuffer::operator new(size_t size, V4L2BufferRefPool* pool) {
+  return pool->Allocate(size);
+}
+
+void V4L2ReadableBuffer::operator delete(void* ptr,
+                                         V4L2BufferRefPool* /* pool */) {
+  V4L2BufferRefPool::Free(ptr);
+}
+
+void V4L2ReadableBuffer::operator delete(void* ptr) {
+  V4L2BufferRefPool::Free(ptr);
+}
+
 const void* V4L2ReadableBuffer::GetPlaneBuffer(const size_t plane) const {
   return buffer_data_->GetPlaneBuffer(plane);
 }
@@ -299,8 +433,7 @@ uint32_t V4L2ReadableBuffer::GetFlags() const {
 /* V4L2WritableBufferRef */
 V4L2WritableBufferRef::V4L2WritableBufferRef(
     const struct v4l2_buffer& buffer, V4L2Queue* queue)
-  : buffer_data_(
-        std::make_unique<V4L2BufferRefBase>(buffer, queue)) {
+  : buffer_data_(V4L2BufferRefBase::Create(buffer, queue)) {
 }
 
 V4L2WritableBufferRef::V4L2WritableBufferRef(V4L2WritableBufferRef&& other)
@@ -414,6 +547,31 @@ bool V4L2WritableBufferRef::QueueUserPtr(const std::vector<void*>& ptrs) && {
   return std::move(self).DoQueue(nullptr);
 }
 
+bool V4L2WritableBufferRef::QueueDMABuf(
+    scoped_refptr<VideoFrame> video_frame) && {
+  V4L2WritableBufferRef self(std::move(*this));
+
+  if (self.Memory() != V4L2_MEMORY_DMABUF) {
+    MCIL_ERROR_PRINT(" Called on invalid buffer type!");
+    return false;
+  }
+
+  if (!video_frame ||
+      (video_frame->dmabuf_fds.size() < self.PlanesCount())) {
+    MCIL_ERROR_PRINT(" Frame has [%zu] dmabufs, [%zu] planes required",
+                     video_frame ? video_frame->dmabuf_fds.size() : 0,
+                     self.PlanesCount());
+    return false;
+  }
+
+  for (size_t i = 0; i < self.PlanesCount(); i++) {
+    self.buffer_data_->buffer_.m.planes[i].m.fd =
+        video_frame->dmabuf_fds[i];
+  }
+
+  return std::move(self).DoQueue(std::move(video_frame));
+}
+
 size_t V4L2WritableBufferRef::PlanesCount() const {
   return buffer_data_->buffer_.length;
 }
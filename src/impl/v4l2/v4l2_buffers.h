@@ -59,29 +59,86 @@ class V4L2Buffer {
 }; /* V4L2Buffer */
 
 /* V4L2BuffersList */
-class V4L2BuffersList : public RefCounted<V4L2BuffersList> {
+// Free buffer indices as a bitmap, one bit per index. All operations are a
+// single atomic instruction or CAS loop, so the client and poll threads
+// never block each other. GetFreeBuffer() returns the lowest free index,
+// unless a given free index is asked for.
+class V4L2BuffersList : public RefCountedThreadSafe<V4L2BuffersList> {
  public:
+  enum { kMaxBuffers = 64 };
+
   V4L2BuffersList() = default;
 
   void ReturnBuffer(size_t buffer_id);
   Optional<size_t> GetFreeBuffer();
+  bool GetFreeBuffer(size_t buffer_id);
   size_t GetSize() const;
 
  private:
-  friend class RefCounted<V4L2BuffersList>;
+  friend class RefCountedThreadSafe<V4L2BuffersList>;
   ~V4L2BuffersList() = default;
 
-  mutable std::mutex lock_;
-  std::set<size_t> free_buffers_ GUARDED_BY(lock_);
+  std::atomic<uint64_t> free_buffers_{0};
 }; /* V4L2BuffersList */
 
+/* V4L2BufferRefPool */
+// Recycles the memory of the buffer ref objects of one queue, so getting,
+// queuing and dequeuing buffers stops allocating once every slot has been
+// used. Slots may be freed on any thread and may outlive the queue: the
+// pool deletes itself when the queue is gone and the last slot is back.
+class V4L2BufferRefPool {
+ public:
+  static V4L2BufferRefPool* Create();
+
+  void* Allocate(size_t size);
+  static void Free(void* ptr);
+
+  // Called by the owning queue instead of delete.
+  void Destroy();
+
+ private:
+  enum { kSizeClasses = 2 };
+
+  struct Slot {
+    V4L2BufferRefPool* pool;
+    Slot* next;
+    size_t size;
+  };
+  // Keeps the objects after the header aligned like operator new would.
+  static constexpr size_t kSlotHeaderSize =
+      (sizeof(Slot) + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+
+  struct FreeList {
+    size_t size = 0;
+    Slot* head = nullptr;
+  };
+
+  V4L2BufferRefPool() = default;
+  ~V4L2BufferRefPool();
+
+  // Returns true if the pool must be deleted.
+  bool Recycle(Slot* slot);
+
+  std::mutex lock_;
+  FreeList free_lists_[kSizeClasses];
+  size_t allocated_slots_ = 0;
+  bool destroyed_ = false;
+}; /* V4L2BufferRefPool */
+
 /* V4L2BufferRefBase */
 class V4L2BufferRefBase {
  public:
+  static std::unique_ptr<V4L2BufferRefBase> Create(
+      const struct v4l2_buffer& buffer, V4L2Queue* queue);
+
   V4L2BufferRefBase(const struct v4l2_buffer& buffer,
                     V4L2Queue* queue);
   ~V4L2BufferRefBase() noexcept(false);
 
+  static void* operator new(size_t size, V4L2BufferRefPool* pool);
+  static void operator delete(void* ptr, V4L2BufferRefPool* pool);
+  static void operator delete(void* ptr);
+
   void* GetPlaneBuffer(const size_t plane);
   bool QueueBuffer(scoped_refptr<VideoFrame> video_frame);
   scoped_refptr<VideoFrame> GetVideoFrame();
@@ -122,6 +179,10 @@ class V4L2ReadableBuffer : public ReadableBuffer {
   virtual void SetFlags(uint32_t flags) override;
   virtual uint32_t GetFlags() const override;
 
+  static void* operator new(size_t size, V4L2BufferRefPool* pool);
+  static void operator delete(void* ptr, V4L2BufferRefPool* pool);
+  static void operator delete(void* ptr);
+
  private:
   V4L2ReadableBuffer(const struct v4l2_buffer& buffer,
                      V4L2Queue* queue,
@@ -157,6 +218,9 @@ class V4L2WritableBufferRef : public WritableBufferRef {
   bool QueueMMap() &&;
   bool QueueUserPtr() &&;
   bool QueueUserPtr(const std::vector<void*>& ptrs) &&;
+  // Queues the dmabufs of |video_frame|, which is kept alive until the
+  // buffer is dequeued. It must carry one fd per plane.
+  bool QueueDMABuf(scoped_refptr<VideoFrame> video_frame) &&;
   size_t PlanesCount() const;
   enum v4l2_memory Memory() const;
   void SetFlags(uint32_t flags);
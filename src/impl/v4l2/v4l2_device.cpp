@@ -4,7 +4,8 @@
 
 #include "v4l2_device.h"
 
-#include <libdrm/drm_fourcc.h>
+#include <poll.h>
+#include <cstdlib>
 #include <cstring>
 #include <sys/ioctl.h>
 
@@ -15,6 +16,9 @@
 
 #include "base/log.h"
 #include "v4l2/generic_v4l2_device.h"
+#if defined(ENABLE_FAKE_V4L2_DEVICE)
+#include "v4l2/fake_v4l2_device.h"
+#endif
 #include "v4l2/v4l2_queue.h"
 
 namespace mcil {
@@ -73,12 +77,25 @@ V4L2ProfileToVideoCodecProfile(VideoCodec codec, uint32_t profile) {
   return VIDEO_CODEC_PROFILE_UNKNOWN;
 }
 
+#if defined(ENABLE_FAKE_V4L2_DEVICE)
+bool UseFakeDevice() {
+  const char* device_to_use = std::getenv("USE_V4L2_DEVICE");
+  return (device_to_use != nullptr) && (strcmp(device_to_use, "FAKE") == 0);
+}
+#endif
+
 } // namespace
 
 #if !defined(PLATFORM_EXTENSION)
 // static
 scoped_refptr<V4L2Device> V4L2Device::Create(DeviceType device_type) {
-  scoped_refptr<V4L2Device> device = new GenericV4L2Device(device_type);
+  scoped_refptr<V4L2Device> device;
+#if defined(ENABLE_FAKE_V4L2_DEVICE)
+  if (UseFakeDevice())
+    device = new FakeV4L2Device(device_type);
+#endif
+  if (!device)
+    device = new GenericV4L2Device(device_type);
   if (device->Initialize())
     return device;
 
@@ -336,7 +353,8 @@ scoped_refptr<VideoFrame> V4L2Device::VideoFrameFromV4L2Format(
 }
 
 V4L2Device::V4L2Device(DeviceType device_type)
- : device_type_(device_type) {
+ : ioctl_stats_(V4L2IoctlStats::CreateIfEnabled(device_type)),
+   device_type_(device_type) {
 }
 
 V4L2Device::~V4L2Device() noexcept(false) {
@@ -612,6 +630,29 @@ bool V4L2Device::SetGOPLength(uint32_t gop_length) {
   return true;
 }
 
+bool V4L2Device::GetPollFds(int32_t* device_fd, int32_t* interrupt_fd) const {
+  return false;
+}
+
+// static
+uint32_t V4L2Device::PollEventsToReadyQueues(uint32_t revents) {
+  if ((revents & POLLERR) != 0)
+    return kAllQueuesReady;
+
+  uint32_t ready_queues = 0;
+  if ((revents & POLLOUT) != 0)
+    ready_queues |= kOutputQueueReady;
+  if ((revents & POLLIN) != 0)
+    ready_queues |= kCaptureQueueReady;
+  return ready_queues;
+}
+
+bool V4L2Device::Poll(bool poll_device, bool* event_pending,
+                      uint32_t* ready_queues) {
+  *ready_queues = poll_device ? kAllQueuesReady : 0;
+  return Poll(poll_device, event_pending);
+}
+
 bool V4L2Device::IsDecoder() {
   return (device_type_ == V4L2_DECODER) || (device_type_ == JPEG_DECODER);
 }
@@ -638,6 +679,12 @@ scoped_refptr<V4L2Queue> V4L2Device::GetQueue(enum v4l2_buf_type buffer_type) {
   return queue;
 }
 
+std::vector<V4L2IoctlCounters> V4L2Device::GetIoctlStats() const {
+  if (!ioctl_stats_)
+    return std::vector<V4L2IoctlCounters>();
+  return ioctl_stats_->Snapshot();
+}
+
 SupportedProfiles
 V4L2Device::EnumerateSupportedDecodeProfiles() {
   SupportedProfiles profiles;
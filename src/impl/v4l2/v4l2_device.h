@@ -9,6 +9,7 @@
 #ifndef SRC_IMPL_V4L2_V4L2_DEVICE_H_
 #define SRC_IMPL_V4L2_V4L2_DEVICE_H_
 
+#include "v4l2/v4l2_ioctl_stats.h"
 #include "v4l2/v4l2_utils.h"
 
 namespace mcil {
@@ -19,6 +20,15 @@ class V4L2Queue;
 
 class V4L2Device : public RefCounted<V4L2Device> {
  public:
+  // Bits of the |ready_queues| mask reported by Poll().
+  enum {
+    // POLLOUT, a buffer of the OUTPUT (bitstream or raw input) queue is done.
+    kOutputQueueReady = 1 << 0,
+    // POLLIN, a buffer of the CAPTURE queue is done.
+    kCaptureQueueReady = 1 << 1,
+    kAllQueuesReady = kOutputQueueReady | kCaptureQueueReady,
+  };
+
   static scoped_refptr<V4L2Device> Create(DeviceType device_type);
 
   static uint32_t VideoCodecProfileToV4L2PixFmt(VideoCodecProfile profile);
@@ -28,10 +38,17 @@ class V4L2Device : public RefCounted<V4L2Device> {
   static size_t GetNumPlanesOfV4L2PixFmt(uint32_t pix_fmt);
   static scoped_refptr<VideoFrame> VideoFrameFromV4L2Format(
       const struct v4l2_format& format);
+  // Maps the revents of the device fd to ready queue bits. POLLERR marks
+  // all queues ready, so that DQBUF reports the error.
+  static uint32_t PollEventsToReadyQueues(uint32_t revents);
 
   virtual bool Open(DeviceType type, uint32_t v4l2_pixfmt) = 0;
   virtual int32_t  Ioctl(int32_t  request, void* arg) = 0;
   virtual bool Poll(bool poll_device, bool* event_pending) = 0;
+  // Same as above, but also reports the queues with a buffer to dequeue.
+  // The default marks all queues ready when the device was polled.
+  virtual bool Poll(bool poll_device, bool* event_pending,
+                    uint32_t* ready_queues);
   virtual bool SetDevicePollInterrupt() = 0;
   virtual bool ClearDevicePollInterrupt() = 0;
   virtual void* Mmap(void* addr, uint32_t len, int32_t prot, int32_t flags,
@@ -59,10 +76,16 @@ class V4L2Device : public RefCounted<V4L2Device> {
   virtual bool SetCtrl(uint32_t ctrl_class, uint32_t ctrl_id, int32_t ctrl_val);
   virtual bool IsCtrlExposed(uint32_t ctrl_id);
   virtual bool SetGOPLength(uint32_t gop_length);
+  // Fds Poll() waits on, for V4L2DevicePoller. Returns false if the device
+  // can only be polled with Poll().
+  virtual bool GetPollFds(int32_t* device_fd, int32_t* interrupt_fd) const;
 
   bool IsDecoder();
   scoped_refptr<V4L2Queue> GetQueue(enum v4l2_buf_type buffer_type);
 
+  // Ioctl counters of this device. Empty unless V4L2_IOCTL_STATS is set.
+  std::vector<V4L2IoctlCounters> GetIoctlStats() const;
+
  protected:
   friend class RefCounted<V4L2Device>;
   using Devices = std::vector<std::pair<std::string, std::vector<uint32_t>>>;
@@ -73,6 +96,10 @@ class V4L2Device : public RefCounted<V4L2Device> {
   SupportedProfiles EnumerateSupportedDecodeProfiles();
   SupportedProfiles EnumerateSupportedEncodeProfiles();
 
+  // Set when ioctl accounting is enabled. Implementations of Ioctl() record
+  // every call into it.
+  std::unique_ptr<V4L2IoctlStats> ioctl_stats_;
+
  private:
   virtual bool Initialize() = 0;
 
@@ -0,0 +1,113 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "v4l2_device_poll_loop.h"
+
+#include "base/futex.h"
+#include "base/log.h"
+
+namespace mcil {
+
+V4L2DevicePollLoop::V4L2DevicePollLoop(const std::string& name)
+  : thread_(name) {
+}
+
+V4L2DevicePollLoop::~V4L2DevicePollLoop() {
+  Stop();
+  thread_.Stop();
+}
+
+void V4L2DevicePollLoop::Start(PollTask poll_task) {
+  if (running_)
+    return;
+  running_ = true;
+
+  // Restarted from its own poll task, the loop has not exited yet.
+  if (IsLoopThread()) {
+    stopping_.store(false, std::memory_order_release);
+    return;
+  }
+
+  // Joins a loop stopped from its own poll task.
+  thread_.Stop();
+
+  poll_task_ = std::move(poll_task);
+  state_.store(kIdle, std::memory_order_relaxed);
+  stopping_.store(false, std::memory_order_relaxed);
+
+  thread_.Start();
+  thread_.PostTask(std::bind(&V4L2DevicePollLoop::Run, this));
+}
+
+void V4L2DevicePollLoop::Stop() {
+  if (!running_)
+    return;
+  running_ = false;
+
+  stopping_.store(true, std::memory_order_release);
+  if (state_.exchange(kArmed, std::memory_order_acq_rel) == kSleeping)
+    FutexWake(&state_);
+
+  // From its own poll task, the loop exits once the task returns, and the
+  // thread is joined by the next Start() or the destructor.
+  if (!IsLoopThread())
+    thread_.Stop();
+}
+
+bool V4L2DevicePollLoop::IsRunning() {
+  return running_;
+}
+
+void V4L2DevicePollLoop::Arm(bool poll_device) {
+  poll_device_.store(poll_device, std::memory_order_relaxed);
+  if (state_.exchange(kArmed, std::memory_order_acq_rel) == kSleeping)
+    FutexWake(&state_);
+}
+
+void V4L2DevicePollLoop::Run() {
+  MCIL_DEBUG_PRINT(": started");
+  loop_thread_id_.store(std::this_thread::get_id(), std::memory_order_relaxed);
+
+  while (true) {
+    // Only this thread moves the state away from kArmed, so a failed
+    // compare exchange means it is armed, or a spurious wake up happened.
+    int32_t state = kIdle;
+    if (state_.compare_exchange_strong(state, kSleeping,
+                                       std::memory_order_acquire) ||
+        (state == kSleeping)) {
+      FutexWait(&state_, kSleeping);
+      continue;
+    }
+
+    // Disarm before polling, so an Arm() racing with the poll below runs
+    // another one instead of being lost.
+    state_.exchange(kIdle, std::memory_order_acquire);
+    if (stopping_.load(std::memory_order_acquire))
+      break;
+
+    poll_task_(poll_device_.load(std::memory_order_relaxed));
+  }
+
+  loop_thread_id_.store(std::thread::id(), std::memory_order_relaxed);
+  MCIL_DEBUG_PRINT(": stopped");
+}
+
+bool V4L2DevicePollLoop::IsLoopThread() const {
+  return loop_thread_id_.load(std::memory_order_relaxed) ==
+         std::this_thread::get_id();
+}
+
+}  // namespace mcil
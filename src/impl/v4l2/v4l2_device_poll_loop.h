@@ -0,0 +1,78 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef SRC_IMPL_V4L2_V4L2_DEVICE_POLL_LOOP_H_
+#define SRC_IMPL_V4L2_V4L2_DEVICE_POLL_LOOP_H_
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+
+#include "base/thread.h"
+
+namespace mcil {
+
+// Per codec device poll thread. Instead of a DevicePollTask() posted for
+// every poll, a single loop runs the poll task each time it is armed, so a
+// poll cycle neither allocates nor takes a lock.
+//
+// Arming is level triggered: Arm() calls made before the loop picks them
+// up are merged into one poll, using the latest |poll_device|. Arm() only
+// makes a wake up syscall when the loop is actually asleep.
+class V4L2DevicePollLoop {
+ public:
+  using PollTask = std::function<void(bool poll_device)>;
+
+  explicit V4L2DevicePollLoop(const std::string& name);
+  ~V4L2DevicePollLoop();
+
+  V4L2DevicePollLoop(const V4L2DevicePollLoop&) = delete;
+  V4L2DevicePollLoop& operator=(const V4L2DevicePollLoop&) = delete;
+
+  // Start() and Stop() may also be called from the poll task itself, e.g.
+  // by a codec serviced directly on the poll thread. Otherwise, Stop() waits
+  // for the loop to exit, and a poll task blocked in V4L2Device::Poll() must
+  // be woken up with SetDevicePollInterrupt() first.
+  void Start(PollTask poll_task);
+  void Stop();
+  bool IsRunning();
+
+  // Runs the poll task once more on the loop thread.
+  void Arm(bool poll_device);
+
+ private:
+  enum { kIdle = 0, kSleeping = 1, kArmed = 2 };
+
+  void Run();
+  bool IsLoopThread() const;
+
+  Thread thread_;
+  PollTask poll_task_;
+  // Owner thread state, the loop thread may outlive a Stop() called from
+  // the poll task.
+  bool running_ = false;
+  std::atomic<std::thread::id> loop_thread_id_{std::thread::id()};
+
+  // Futex word, one of the states above.
+  std::atomic<int32_t> state_{kIdle};
+  std::atomic<bool> poll_device_{false};
+  std::atomic<bool> stopping_{false};
+};
+
+}  // namespace mcil
+
+#endif  // SRC_IMPL_V4L2_V4L2_DEVICE_POLL_LOOP_H_
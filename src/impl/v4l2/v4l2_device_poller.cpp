@@ -0,0 +1,250 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "v4l2_device_poller.h"
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include "base/log.h"
+#include "base/trace_event.h"
+#include "v4l2/v4l2_device.h"
+
+namespace mcil {
+
+namespace {
+
+const int32_t kMaxEvents = 16;
+
+// Same events GenericV4L2Device::Poll() waits for.
+const uint32_t kDeviceEvents = EPOLLIN | EPOLLOUT | EPOLLERR | EPOLLPRI;
+const uint32_t kInterruptEvents = EPOLLIN | EPOLLERR;
+
+// The low bit of the epoll data tells the device fd from the interrupt fd.
+uint64_t EventData(uint64_t id, bool device_fd) {
+  return (id << 1) | (device_fd ? 1 : 0);
+}
+
+bool SharedPollEnabled() {
+  const char* value = std::getenv("V4L2_SHARED_POLL");
+  return (value != nullptr) && (strcmp(value, "1") == 0);
+}
+
+}  // namespace
+
+// static
+V4L2DevicePoller* V4L2DevicePoller::Get() {
+  // Never destroyed, codecs may unregister from static destructors.
+  static V4L2DevicePoller* poller = []() -> V4L2DevicePoller* {
+    if (!SharedPollEnabled())
+      return nullptr;
+
+    V4L2DevicePoller* instance = new V4L2DevicePoller();
+    if (!instance->Initialize()) {
+      MCIL_ERROR_PRINT(": Failed, falling back to per codec poll threads");
+      return nullptr;
+    }
+    return instance;
+  }();
+
+  return poller;
+}
+
+V4L2DevicePoller::V4L2DevicePoller() = default;
+
+bool V4L2DevicePoller::Initialize() {
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd_ < 0) {
+    MCIL_ERROR_PRINT(": epoll_create1() failed: %s", strerror(errno));
+    return false;
+  }
+
+  thread_ = std::thread(&V4L2DevicePoller::Run, this);
+  MCIL_INFO_PRINT(": Shared device poller started");
+  return true;
+}
+
+bool V4L2DevicePoller::Register(scoped_refptr<V4L2Device> device,
+                                Callback callback) {
+  int32_t device_fd = -1;
+  int32_t interrupt_fd = -1;
+  if (!device || !device->GetPollFds(&device_fd, &interrupt_fd))
+    return false;
+
+  std::lock_guard<std::mutex> lock(lock_);
+  if (registrations_.find(device.get()) != registrations_.end()) {
+    MCIL_ERROR_PRINT(": device %p already registered", device.get());
+    return false;
+  }
+
+  std::unique_ptr<Registration> registration(new Registration());
+  registration->device = device;
+  registration->callback = std::move(callback);
+  registration->id = next_id_++;
+  registration->device_fd = device_fd;
+  registration->interrupt_fd = interrupt_fd;
+
+  // Added disabled, Arm() enables them.
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLONESHOT;
+  event.data.u64 = EventData(registration->id, false);
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, interrupt_fd, &event) != 0) {
+    MCIL_ERROR_PRINT(": EPOLL_CTL_ADD failed: %s", strerror(errno));
+    return false;
+  }
+
+  event.data.u64 = EventData(registration->id, true);
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, device_fd, &event) != 0) {
+    MCIL_ERROR_PRINT(": EPOLL_CTL_ADD failed: %s", strerror(errno));
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, interrupt_fd, nullptr);
+    return false;
+  }
+
+  MCIL_DEBUG_PRINT(": device %p fds[%d, %d] id[%llu]", device.get(),
+                   device_fd, interrupt_fd,
+                   static_cast<unsigned long long>(registration->id));
+  registrations_by_id_[registration->id] = registration.get();
+  registrations_[device.get()] = std::move(registration);
+  return true;
+}
+
+void V4L2DevicePoller::Unregister(V4L2Device* device) {
+  std::unique_lock<std::mutex> lock(lock_);
+  auto it = registrations_.find(device);
+  if (it == registrations_.end())
+    return;
+
+  Registration* registration = it->second.get();
+  registration->armed = false;
+  if (std::this_thread::get_id() != thread_.get_id()) {
+    callback_done_.wait(lock, [this, registration] {
+      return running_id_ != registration->id;
+    });
+  }
+
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, registration->device_fd, nullptr);
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, registration->interrupt_fd, nullptr);
+  registrations_by_id_.erase(registration->id);
+  registrations_.erase(it);
+}
+
+bool V4L2DevicePoller::Arm(V4L2Device* device, bool poll_device) {
+  std::lock_guard<std::mutex> lock(lock_);
+  auto it = registrations_.find(device);
+  if (it == registrations_.end())
+    return false;
+
+  Registration* registration = it->second.get();
+  registration->armed = true;
+  // Device fd first: an interrupt already pending wakes epoll_wait() as
+  // soon as it is enabled, and its batch must not miss the device events.
+  uint32_t device_events = poll_device ? kDeviceEvents : 0;
+  if (!Modify(registration->device_fd, device_events | EPOLLONESHOT,
+              EventData(registration->id, true))) {
+    return false;
+  }
+
+  return Modify(registration->interrupt_fd, kInterruptEvents | EPOLLONESHOT,
+                EventData(registration->id, false));
+}
+
+void V4L2DevicePoller::Run() {
+  MCIL_TRACE_SET_THREAD_NAME("V4L2DevicePollerThread");
+
+  struct epoll_event events[kMaxEvents];
+  while (true) {
+    int32_t count = epoll_wait(epoll_fd_, events, kMaxEvents, -1);
+    if (count < 0) {
+      if (errno == EINTR)
+        continue;
+      MCIL_ERROR_PRINT(": epoll_wait() failed: %s", strerror(errno));
+      return;
+    }
+
+    // Both fds of a registration may be ready in one batch. Merge them, so
+    // the device events are not lost to the interrupt disarming it first.
+    uint64_t ids[kMaxEvents];
+    uint32_t device_events[kMaxEvents];
+    int32_t dispatch_count = 0;
+    for (int32_t i = 0; i < count; ++i) {
+      uint64_t id = events[i].data.u64 >> 1;
+      uint32_t fd_device_events =
+          ((events[i].data.u64 & 1) != 0) ? events[i].events : 0;
+
+      int32_t j = 0;
+      while ((j < dispatch_count) && (ids[j] != id))
+        ++j;
+      if (j == dispatch_count) {
+        ids[dispatch_count] = id;
+        device_events[dispatch_count++] = 0;
+      }
+      device_events[j] |= fd_device_events;
+    }
+
+    for (int32_t i = 0; i < dispatch_count; ++i)
+      Dispatch(ids[i], device_events[i]);
+  }
+}
+
+void V4L2DevicePoller::Dispatch(uint64_t id, uint32_t device_events) {
+  std::unique_lock<std::mutex> lock(lock_);
+  auto it = registrations_by_id_.find(id);
+  // The other fd of a registration may fire in a later batch, after the
+  // first one disarmed it. Its EPOLLONESHOT disabled it again, the next
+  // Arm() re-enables it.
+  if ((it == registrations_by_id_.end()) || !it->second->armed)
+    return;
+
+  Registration* registration = it->second;
+  registration->armed = false;
+  running_id_ = registration->id;
+
+  // Copied, so the callback may unregister its own device.
+  Callback callback = registration->callback;
+  bool event_pending = ((device_events & EPOLLPRI) != 0);
+  // The EPOLL* event bits have the same values as the POLL* ones.
+  uint32_t ready_queues = V4L2Device::PollEventsToReadyQueues(device_events);
+  lock.unlock();
+
+  {
+    MCIL_TRACE_EVENT1("V4L2DevicePoller::Dispatch", "event_pending",
+                      event_pending);
+    callback(event_pending, ready_queues);
+  }
+
+  lock.lock();
+  running_id_ = 0;
+  callback_done_.notify_all();
+}
+
+bool V4L2DevicePoller::Modify(int32_t fd, uint32_t events, uint64_t data) {
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = events;
+  event.data.u64 = data;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event) != 0) {
+    MCIL_ERROR_PRINT(": EPOLL_CTL_MOD fd[%d] failed: %s", fd, strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+}  // namespace mcil
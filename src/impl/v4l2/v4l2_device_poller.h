@@ -0,0 +1,97 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef SRC_IMPL_V4L2_V4L2_DEVICE_POLLER_H_
+#define SRC_IMPL_V4L2_V4L2_DEVICE_POLLER_H_
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "base/scoped_refptr.h"
+
+namespace mcil {
+
+class V4L2Device;
+
+// Process wide replacement for the per codec device poll threads. Every
+// registered device adds its device fd and poll interrupt fd to one epoll
+// set, serviced by a single thread. Enabled with V4L2_SHARED_POLL=1.
+//
+// Polling is one shot, like a DevicePollTask(): after Arm(), the callback
+// runs once on the poller thread when the interrupt fd, or the device fd if
+// |poll_device| was set, becomes readable. It must only hand the work over
+// to the codec thread. |ready_queues| is a mask of the V4L2Device ready
+// queue bits, as reported by V4L2Device::Poll().
+class V4L2DevicePoller {
+ public:
+  using Callback =
+      std::function<void(bool event_pending, uint32_t ready_queues)>;
+
+  // Returns nullptr unless the shared poller is enabled.
+  static V4L2DevicePoller* Get();
+
+  V4L2DevicePoller(const V4L2DevicePoller&) = delete;
+  V4L2DevicePoller& operator=(const V4L2DevicePoller&) = delete;
+
+  // Fails if |device| cannot be polled through its fds, the caller should
+  // then fall back to its own poll thread.
+  bool Register(scoped_refptr<V4L2Device> device, Callback callback);
+  // Waits for a running callback of |device| to return, unless called from
+  // that callback.
+  void Unregister(V4L2Device* device);
+  bool Arm(V4L2Device* device, bool poll_device);
+
+ private:
+  struct Registration {
+    scoped_refptr<V4L2Device> device;
+    Callback callback;
+    uint64_t id = 0;
+    int32_t device_fd = -1;
+    int32_t interrupt_fd = -1;
+    bool armed = false;
+  };
+
+  V4L2DevicePoller();
+  ~V4L2DevicePoller() = delete;
+
+  bool Initialize();
+  void Run();
+  // |device_events| are the events of the device fd, 0 when only the
+  // interrupt fd is ready.
+  void Dispatch(uint64_t id, uint32_t device_events);
+  bool Modify(int32_t fd, uint32_t events, uint64_t data);
+
+  int32_t epoll_fd_ = -1;
+  std::thread thread_;
+
+  std::mutex lock_;
+  // Signaled when |running_id_| is cleared.
+  std::condition_variable callback_done_;
+  std::map<V4L2Device*, std::unique_ptr<Registration>> registrations_;
+  // epoll data is the registration id, so a stale event of an unregistered
+  // device never touches freed memory.
+  std::map<uint64_t, Registration*> registrations_by_id_;
+  uint64_t next_id_ = 1;
+  uint64_t running_id_ = 0;
+};
+
+}  // namespace mcil
+
+#endif  // SRC_IMPL_V4L2_V4L2_DEVICE_POLLER_H_
@@ -0,0 +1,198 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "v4l2_ioctl_stats.h"
+
+#include <cstdlib>
+
+#include "base/log.h"
+
+namespace mcil {
+
+namespace {
+
+bool IoctlStatsEnabled() {
+  const char* value = std::getenv("V4L2_IOCTL_STATS");
+  return (value != nullptr) && (strcmp(value, "0") != 0);
+}
+
+const char* DeviceTypeToString(DeviceType device_type) {
+  switch (device_type) {
+    case V4L2_DECODER:
+      return "decoder";
+    case V4L2_ENCODER:
+      return "encoder";
+    case JPEG_DECODER:
+      return "jpeg_decoder";
+    case IMAGE_PROCESSOR:
+      return "image_processor";
+  }
+  return "device";
+}
+
+std::mutex& RegistryLock() {
+  static std::mutex lock;
+  return lock;
+}
+
+std::set<V4L2IoctlStats*>& Registry() {
+  static std::set<V4L2IoctlStats*> instances;
+  return instances;
+}
+
+}  // namespace
+
+// static
+std::unique_ptr<V4L2IoctlStats> V4L2IoctlStats::CreateIfEnabled(
+    DeviceType device_type) {
+  static std::atomic<uint32_t> next_id{0};
+
+  if (!IoctlStatsEnabled())
+    return nullptr;
+
+  std::string label = std::string(DeviceTypeToString(device_type)) + "#" +
+                      std::to_string(next_id.fetch_add(1));
+  return std::unique_ptr<V4L2IoctlStats>(new V4L2IoctlStats(label));
+}
+
+// static
+std::map<std::string, std::vector<V4L2IoctlCounters>>
+V4L2IoctlStats::SnapshotAll() {
+  std::map<std::string, std::vector<V4L2IoctlCounters>> snapshot;
+
+  std::lock_guard<std::mutex> lock(RegistryLock());
+  for (const auto* stats : Registry())
+    snapshot[stats->label()] = stats->Snapshot();
+  return snapshot;
+}
+
+// static
+std::string V4L2IoctlStats::RequestToString(uint32_t request) {
+#define REQUEST_STR(x) \
+  case static_cast<uint32_t>(x): \
+    return #x
+
+  switch (request) {
+    REQUEST_STR(VIDIOC_QUERYCAP);
+    REQUEST_STR(VIDIOC_ENUM_FMT);
+    REQUEST_STR(VIDIOC_ENUM_FRAMESIZES);
+    REQUEST_STR(VIDIOC_G_FMT);
+    REQUEST_STR(VIDIOC_S_FMT);
+    REQUEST_STR(VIDIOC_TRY_FMT);
+    REQUEST_STR(VIDIOC_REQBUFS);
+    REQUEST_STR(VIDIOC_QUERYBUF);
+    REQUEST_STR(VIDIOC_QBUF);
+    REQUEST_STR(VIDIOC_DQBUF);
+    REQUEST_STR(VIDIOC_EXPBUF);
+    REQUEST_STR(VIDIOC_STREAMON);
+    REQUEST_STR(VIDIOC_STREAMOFF);
+    REQUEST_STR(VIDIOC_S_PARM);
+    REQUEST_STR(VIDIOC_G_CTRL);
+    REQUEST_STR(VIDIOC_S_CTRL);
+    REQUEST_STR(VIDIOC_G_EXT_CTRLS);
+    REQUEST_STR(VIDIOC_S_EXT_CTRLS);
+    REQUEST_STR(VIDIOC_QUERYCTRL);
+    REQUEST_STR(VIDIOC_QUERYMENU);
+    REQUEST_STR(VIDIOC_G_CROP);
+    REQUEST_STR(VIDIOC_S_CROP);
+    REQUEST_STR(VIDIOC_G_SELECTION);
+    REQUEST_STR(VIDIOC_S_SELECTION);
+    REQUEST_STR(VIDIOC_SUBSCRIBE_EVENT);
+    REQUEST_STR(VIDIOC_UNSUBSCRIBE_EVENT);
+    REQUEST_STR(VIDIOC_DQEVENT);
+    REQUEST_STR(VIDIOC_DECODER_CMD);
+    REQUEST_STR(VIDIOC_TRY_DECODER_CMD);
+    REQUEST_STR(VIDIOC_ENCODER_CMD);
+    REQUEST_STR(VIDIOC_TRY_ENCODER_CMD);
+  }
+#undef REQUEST_STR
+
+  return "VIDIOC_" + std::to_string(_IOC_NR(request));
+}
+
+V4L2IoctlStats::V4L2IoctlStats(std::string label) : label_(std::move(label)) {
+  std::lock_guard<std::mutex> lock(RegistryLock());
+  Registry().insert(this);
+}
+
+V4L2IoctlStats::~V4L2IoctlStats() {
+  {
+    std::lock_guard<std::mutex> lock(RegistryLock());
+    Registry().erase(this);
+  }
+  Log();
+}
+
+void V4L2IoctlStats::Record(int32_t request, int32_t error,
+                            MonotonicTime start) {
+  uint64_t elapsed_ns = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start).count());
+
+  Slot& slot = slots_[_IOC_NR(static_cast<uint32_t>(request))];
+  slot.request.store(static_cast<uint32_t>(request),
+                     std::memory_order_relaxed);
+  slot.calls.fetch_add(1, std::memory_order_relaxed);
+  if (error != 0) {
+    slot.errors.fetch_add(1, std::memory_order_relaxed);
+    if (error == EAGAIN)
+      slot.eagain.fetch_add(1, std::memory_order_relaxed);
+  }
+  slot.total_ns.fetch_add(elapsed_ns, std::memory_order_relaxed);
+
+  uint64_t max_ns = slot.max_ns.load(std::memory_order_relaxed);
+  while ((elapsed_ns > max_ns) &&
+         !slot.max_ns.compare_exchange_weak(max_ns, elapsed_ns,
+                                            std::memory_order_relaxed)) {
+  }
+}
+
+std::vector<V4L2IoctlCounters> V4L2IoctlStats::Snapshot() const {
+  std::vector<V4L2IoctlCounters> counters;
+  for (const auto& slot : slots_) {
+    uint64_t calls = slot.calls.load(std::memory_order_relaxed);
+    if (calls == 0)
+      continue;
+
+    V4L2IoctlCounters counter;
+    counter.request = slot.request.load(std::memory_order_relaxed);
+    counter.calls = calls;
+    counter.errors = slot.errors.load(std::memory_order_relaxed);
+    counter.eagain = slot.eagain.load(std::memory_order_relaxed);
+    counter.total_ns = slot.total_ns.load(std::memory_order_relaxed);
+    counter.max_ns = slot.max_ns.load(std::memory_order_relaxed);
+    counters.push_back(counter);
+  }
+  return counters;
+}
+
+void V4L2IoctlStats::Log() const {
+  for (const auto& counter : Snapshot()) {
+    MCIL_INFO_PRINT(" %s %s: calls[%llu] errors[%llu] eagain[%llu] "
+                    "total[%lluns] avg[%lluns] max[%lluns]",
+                    label_.c_str(),
+                    RequestToString(counter.request).c_str(),
+                    static_cast<unsigned long long>(counter.calls),
+                    static_cast<unsigned long long>(counter.errors),
+                    static_cast<unsigned long long>(counter.eagain),
+                    static_cast<unsigned long long>(counter.total_ns),
+                    static_cast<unsigned long long>(
+                        counter.total_ns / counter.calls),
+                    static_cast<unsigned long long>(counter.max_ns));
+  }
+}
+
+}  //  namespace mcil
@@ -0,0 +1,87 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef SRC_IMPL_V4L2_V4L2_IOCTL_STATS_H_
+#define SRC_IMPL_V4L2_V4L2_IOCTL_STATS_H_
+
+#include <memory>
+#include <string>
+
+#include "v4l2/v4l2_utils.h"
+
+namespace mcil {
+
+class V4L2IoctlCounters {
+ public:
+  V4L2IoctlCounters() = default;
+  ~V4L2IoctlCounters() = default;
+
+  uint32_t request = 0;
+  uint64_t calls = 0;
+  uint64_t errors = 0;
+  // Subset of |errors| that failed with EAGAIN, e.g. DQBUF on an empty queue.
+  uint64_t eagain = 0;
+  uint64_t total_ns = 0;
+  uint64_t max_ns = 0;
+};
+
+// Per device ioctl accounting: number of calls, failures and time spent in
+// the kernel for each request code. Only created when V4L2_IOCTL_STATS is
+// set in the environment, so devices pay a single null check otherwise.
+// Counters are relaxed atomics and can be read from any thread.
+class V4L2IoctlStats {
+ public:
+  static std::unique_ptr<V4L2IoctlStats> CreateIfEnabled(
+      DeviceType device_type);
+
+  // Counters of every live instance, keyed by instance label.
+  static std::map<std::string, std::vector<V4L2IoctlCounters>> SnapshotAll();
+  static std::string RequestToString(uint32_t request);
+
+  ~V4L2IoctlStats();
+
+  V4L2IoctlStats(const V4L2IoctlStats&) = delete;
+  V4L2IoctlStats& operator=(const V4L2IoctlStats&) = delete;
+
+  // |error| is the errno of a failed call and 0 on success.
+  void Record(int32_t request, int32_t error, MonotonicTime start);
+
+  const std::string& label() const { return label_; }
+  std::vector<V4L2IoctlCounters> Snapshot() const;
+  void Log() const;
+
+ private:
+  // V4L2 request codes are unique in their _IOC_NR() byte.
+  enum { kSlotCount = 256 };
+
+  struct Slot {
+    std::atomic<uint32_t> request{0};
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> errors{0};
+    std::atomic<uint64_t> eagain{0};
+    std::atomic<uint64_t> total_ns{0};
+    std::atomic<uint64_t> max_ns{0};
+  };
+
+  explicit V4L2IoctlStats(std::string label);
+
+  std::string label_;
+  Slot slots_[kSlotCount];
+};
+
+}  // namespace mcil
+
+#endif  // SRC_IMPL_V4L2_V4L2_IOCTL_STATS_H_
@@ -5,6 +5,7 @@
 #include "v4l2_queue.h"
 
 #include "base/log.h"
+#include "base/trace_event.h"
 #include "v4l2/v4l2_buffers.h"
 #include "v4l2/v4l2_device.h"
 
@@ -59,8 +60,8 @@ ReadableBufferRef V4L2BufferRefFactory::CreateReadableRef(
     const struct v4l2_buffer& buffer,
     V4L2Queue* queue,
     scoped_refptr<VideoFrame> video_frame) {
-  V4L2ReadableBuffer* readable_buffer =
-      new V4L2ReadableBuffer(buffer, queue, std::move(video_frame));
+  V4L2ReadableBuffer* readable_buffer = new (queue->ref_pool_)
+      V4L2ReadableBuffer(buffer, queue, std::move(video_frame));
   return (ReadableBuffer*)readable_buffer;
 }
 
@@ -69,10 +70,12 @@ V4L2Queue::V4L2Queue(scoped_refptr<V4L2Device> device,
                      enum v4l2_buf_type buffer_type,
                      V4L2BufferDestroyCb destroy_cb)
   : buffer_type_(buffer_type),
-    device_(std::move(device)) {
+    device_(std::move(device)),
+    ref_pool_(V4L2BufferRefPool::Create()) {
 }
 
 V4L2Queue::~V4L2Queue() noexcept(false){
+  ref_pool_->Destroy();
 }
 
 Optional<Rect> V4L2Queue::GetVisibleRect() {
@@ -160,10 +163,13 @@ bool V4L2Queue::StreamOff() {
     return false;
   }
 
-  for (const auto& it : queued_buffers_)
-    free_buffers_->ReturnBuffer(it.first);
+  while (queued_mask_ != 0) {
+    size_t index = static_cast<size_t>(__builtin_ctzll(queued_mask_));
+    queued_mask_ &= queued_mask_ - 1;
+    queued_frames_[index] = nullptr;
+    free_buffers_->ReturnBuffer(index);
+  }
 
-  queued_buffers_.clear();
   streaming_state_ = false;
   return true;
 }
@@ -214,6 +220,8 @@ size_t V4L2Queue::AllocateBuffers(size_t count, enum v4l2_memory memory) {
 
   memory_ = memory;
   free_buffers_ = new V4L2BuffersList();
+  queued_frames_.resize(buffer_count);
+  queued_mask_ = 0;
 
   // Now query all buffer information.
   for (size_t i = 0; i < buffer_count; i++) {
@@ -241,6 +249,8 @@ bool V4L2Queue::DeallocateBuffers() {
     return true;
 
   buffers_.clear();
+  queued_frames_.clear();
+  queued_mask_ = 0;
   free_buffers_ = nullptr;
 
   struct v4l2_requestbuffers reqbufs;
@@ -266,7 +276,11 @@ size_t V4L2Queue::FreeBuffersCount() const {
 }
 
 size_t V4L2Queue::QueuedBuffersCount() const {
-  return queued_buffers_.size();
+  return static_cast<size_t>(__builtin_popcountll(queued_mask_));
+}
+
+size_t V4L2Queue::PlanesCount() const {
+  return planes_count_;
 }
 
 Optional<V4L2WritableBufferRef> V4L2Queue::GetFreeBuffer() {
@@ -284,6 +298,18 @@ Optional<V4L2WritableBufferRef> V4L2Queue::GetFreeBuffer() {
       buffers_[buffer_id.value()]->get_v4l2_buffer(), this);
 }
 
+Optional<V4L2WritableBufferRef> V4L2Queue::GetFreeBuffer(
+    size_t requested_buffer_id) {
+  if (!free_buffers_ || (requested_buffer_id >= buffers_.size()))
+    return nullopt;
+
+  if (!free_buffers_->GetFreeBuffer(requested_buffer_id))
+    return nullopt;
+
+  return V4L2BufferRefFactory::CreateWritableRef(
+      buffers_[requested_buffer_id]->get_v4l2_buffer(), this);
+}
+
 V4L2WritableBufferRef* V4L2Queue::GetFreeBufferPtr() {
   // No buffers allocated at the moment?
   if (!free_buffers_) {
@@ -319,6 +345,10 @@ std::pair<bool, ReadableBufferRef> V4L2Queue::DequeueBuffer() {
   read_v4l2_buf.memory = memory_;
   read_v4l2_buf.m.planes = planes;
   read_v4l2_buf.length = static_cast<uint32_t>(planes_count_);
+
+  MCIL_TRACE_EVENT((buffer_type_ == V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE)
+                       ? "V4L2Queue::DQBUF input"
+                       : "V4L2Queue::DQBUF output");
   int32_t ret = device_->Ioctl(VIDIOC_DQBUF, &read_v4l2_buf);
   if (ret != 0) {
     switch (errno) {
@@ -336,12 +366,13 @@ std::pair<bool, ReadableBufferRef> V4L2Queue::DequeueBuffer() {
     }
   }
 
-  auto it = queued_buffers_.find(read_v4l2_buf.index);
-  if (it == queued_buffers_.end())
+  size_t index = read_v4l2_buf.index;
+  if ((index >= queued_frames_.size()) ||
+      !(queued_mask_ & (uint64_t(1) << index)))
     return std::make_pair(false, nullptr);
 
-  scoped_refptr<VideoFrame> queued_frame = std::move(it->second);
-  queued_buffers_.erase(it);
+  scoped_refptr<VideoFrame> queued_frame = std::move(queued_frames_[index]);
+  queued_mask_ &= ~(uint64_t(1) << index);
 
   return std::make_pair(true, V4L2BufferRefFactory::CreateReadableRef(
                                   read_v4l2_buf, this,
@@ -350,6 +381,16 @@ std::pair<bool, ReadableBufferRef> V4L2Queue::DequeueBuffer() {
 
 bool V4L2Queue::QueueBuffer(struct v4l2_buffer* buffer,
                             scoped_refptr<VideoFrame> video_frame) {
+  MCIL_TRACE_EVENT1((buffer_type_ == V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE)
+                        ? "V4L2Queue::QBUF input"
+                        : "V4L2Queue::QBUF output",
+                    "index", buffer->index);
+  // Checked before QBUF, a buffer the driver owns must be tracked.
+  if (buffer->index >= queued_frames_.size()) {
+    MCIL_ERROR_PRINT(": Invalid buffer index [%u]", buffer->index);
+    return false;
+  }
+
   int32_t  ret = device_->Ioctl(VIDIOC_QBUF, buffer);
   if (ret) {
     if (buffer_type_ == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE &&
@@ -358,8 +399,8 @@ bool V4L2Queue::QueueBuffer(struct v4l2_buffer* buffer,
     return false;
   }
 
-  auto inserted =
-      queued_buffers_.emplace(buffer->index, std::move(video_frame));
+  queued_frames_[buffer->index] = std::move(video_frame);
+  queued_mask_ |= uint64_t(1) << buffer->index;
   return true;
 }
 
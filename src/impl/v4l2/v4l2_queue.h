@@ -14,6 +14,7 @@
 namespace mcil {
 
 class V4L2Buffer;
+class V4L2BufferRefPool;
 class V4L2BuffersList;
 class V4L2Device;
 class V4L2WritableBufferRef;
@@ -41,8 +42,12 @@ class V4L2Queue : public RefCounted<V4L2Queue> {
   virtual size_t AllocatedBuffersCount() const;
   virtual size_t FreeBuffersCount() const;
   virtual size_t QueuedBuffersCount() const;
+  virtual size_t PlanesCount() const;
 
   virtual Optional<V4L2WritableBufferRef> GetFreeBuffer();
+  // Returns the buffer at |requested_buffer_id| if it is free.
+  virtual Optional<V4L2WritableBufferRef> GetFreeBuffer(
+      size_t requested_buffer_id);
   virtual V4L2WritableBufferRef* GetFreeBufferPtr();
   virtual std::pair<bool, ReadableBufferRef> DequeueBuffer();
   virtual bool QueueBuffer(struct v4l2_buffer* buffer,
@@ -52,6 +57,7 @@ class V4L2Queue : public RefCounted<V4L2Queue> {
   friend class RefCounted<V4L2Queue>;
   friend class V4L2QueueFactory;
   friend class V4L2BufferRefBase;
+  friend class V4L2BufferRefFactory;
 
   V4L2Queue(scoped_refptr<V4L2Device> device,
             enum v4l2_buf_type buffer_type,
@@ -62,8 +68,13 @@ class V4L2Queue : public RefCounted<V4L2Queue> {
   scoped_refptr<V4L2Device> device_;
 
   scoped_refptr<V4L2BuffersList> free_buffers_;
-  std::map<size_t, scoped_refptr<VideoFrame>> queued_buffers_;
+  // Memory of the buffer refs handed out by this queue.
+  V4L2BufferRefPool* ref_pool_ = nullptr;
   std::vector<std::unique_ptr<V4L2Buffer>> buffers_;
+  // Indexed by v4l2_buffer.index, sized with |buffers_|. Bit i of
+  // |queued_mask_| is set while buffer i is owned by the driver.
+  std::vector<scoped_refptr<VideoFrame>> queued_frames_;
+  uint64_t queued_mask_ = 0;
 
   size_t planes_count_ = 0;
   enum v4l2_memory memory_ = V4L2_MEMORY_MMAP;
@@ -4,14 +4,18 @@
 
 #include "v4l2_video_decoder.h"
 
+#include <algorithm>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <unistd.h>
 
 #include "base/fourcc.h"
 #include "base/log.h"
+#include "base/trace_event.h"
 #include "base/video_decoder_client.h"
 #include "v4l2/v4l2_device.h"
+#include "v4l2/v4l2_device_poller.h"
 #include "v4l2/v4l2_queue.h"
 
 namespace mcil {
@@ -37,7 +41,7 @@ V4L2VideoDecoder::V4L2VideoDecoder()
  : VideoDecoder(),
    device_(V4L2Device::Create(V4L2_DECODER)),
    output_mode_(OUTPUT_ALLOCATE),
-   device_poll_thread_("V4L2DecoderDevicePollThread"),
+   device_poll_loop_("V4L2DecoderDevicePollThread"),
    decoder_state_(kUninitialized) {
 }
 
@@ -56,6 +60,8 @@ bool V4L2VideoDecoder::Initialize(const DecoderConfig* config,
     MCIL_ERROR_PRINT(" Delegate not provided");
     return false;
   }
+  batched_output_ = client_->UseBatchedOutput();
+  direct_dispatch_lock_ = client_->DirectDispatchLock();
 
   if (vdec_port_index < 0) {
     MCIL_ERROR_PRINT(": Resource not aquired: %d", vdec_port_index);
@@ -96,6 +102,7 @@ void V4L2VideoDecoder::Destroy() {
   StopInputStream();
 
   current_input_buffer_.reset();
+  input_buffer_leased_ = false;
 
   DestroyInputBuffers();
   DestroyOutputBuffers();
@@ -105,11 +112,12 @@ void V4L2VideoDecoder::Destroy() {
 
   device_ = nullptr;
 
-  start_time_ = ChronoTime();
+  start_time_ = MonotonicTime();
 }
 
 bool V4L2VideoDecoder::ResetInputBuffer() {
   current_input_buffer_.reset();
+  input_buffer_leased_ = false;
   return true;
 }
 
@@ -132,7 +140,7 @@ bool V4L2VideoDecoder::ResetDecodingBuffers(bool* reset_pending) {
 }
 
 bool V4L2VideoDecoder::CanNotifyResetDone() {
-  if (device_poll_thread_.IsRunning())
+  if (IsDevicePollRunning())
     return true;
 
   return StartDevicePoll();
@@ -144,61 +152,92 @@ bool V4L2VideoDecoder::DecodeBuffer(const void* buffer,
                                     int64_t buffer_pts) {
   MCIL_DEBUG_PRINT(": buffer[%p], size[%lu], id[%d], pts[%ld]",
                    buffer, buffer_size, buffer_id, buffer_pts);
+  MCIL_TRACE_EVENT1("V4L2VideoDecoder::DecodeBuffer", "buffer_id", buffer_id);
 
-    // Flush if we're too big
-  if (current_input_buffer_) {
-    size_t plane_size = current_input_buffer_->GetBufferSize(0);
-    size_t bytes_used = current_input_buffer_->GetBytesUsed(0);
-    if ((bytes_used + buffer_size) > plane_size) {
-      if (!FlushInputBuffers()) {
-        return false;
-      }
-    }
+  if (input_buffer_leased_) {
+    MCIL_ERROR_PRINT(": input buffer leased, commit it first");
+    return false;
   }
 
-  // Try to get an available input buffer.
-  if (!current_input_buffer_) {
-    if (input_queue_->FreeBuffersCount() == 0)
-      DequeueBuffers();
-
-    current_input_buffer_ = input_queue_->GetFreeBuffer();
-    if (!current_input_buffer_) {
-      MCIL_DEBUG_PRINT(": stalled for input buffers");
+    // Flush if we're too big
+  if (current_input_buffer_ && !InputBufferHasRoom(buffer_size)) {
+    if (!FlushInputBuffers()) {
       return false;
     }
-
-    struct timeval timestamp = { .tv_sec = buffer_id };
-    current_input_buffer_->SetTimeStamp(timestamp);
-    current_input_buffer_->SetBufferId(buffer_id);
   }
 
+  // Try to get an available input buffer.
+  if (!current_input_buffer_ && !GetFreeInputBuffer())
+    return false;
+  if (!current_input_buffer_has_id_)
+    SetInputBufferId(buffer_id);
+
   if (buffer_size == 0) {
     MCIL_DEBUG_PRINT(": buffer_size is zero. buffer_id= %d", buffer_id);
     return true;
   }
 
   // Copy in to the buffer.
-  size_t plane_size = current_input_buffer_->GetBufferSize(0);
-  size_t bytes_used = current_input_buffer_->GetBytesUsed(0);
-
-  if (buffer_size > (plane_size - bytes_used)) {
-    MCIL_ERROR_PRINT(": over-size frame, erroring");
-    NOTIFY_ERROR(UNREADABLE_INPUT);
+  uint8_t* input_buffer = GetInputBufferSpace(buffer_size);
+  if (input_buffer == nullptr)
     return false;
+
+  memcpy(input_buffer, buffer, buffer_size);
+  AddInputBytesUsed(buffer_size);
+
+  return true;
+}
+
+void* V4L2VideoDecoder::AcquireInputBuffer(size_t min_size) {
+  MCIL_DEBUG_PRINT(": min_size[%zu]", min_size);
+
+  if (input_buffer_leased_) {
+    MCIL_ERROR_PRINT(": input buffer already leased");
+    return nullptr;
   }
 
-  void* input_buffer = current_input_buffer_->GetPlaneBuffer(0);
-  if (input_buffer == nullptr) {
-    MCIL_ERROR_PRINT(": Error allocating input buffer");
+  if (current_input_buffer_ && !InputBufferHasRoom(min_size)) {
+    if (!FlushInputBuffers())
+      return nullptr;
+  }
+
+  // The buffer id is only known on commit.
+  if (!current_input_buffer_ && !GetFreeInputBuffer())
+    return nullptr;
+
+  uint8_t* input_buffer = GetInputBufferSpace(min_size);
+  if (input_buffer == nullptr)
+    return nullptr;
+
+  input_buffer_leased_ = true;
+  return input_buffer;
+}
+
+bool V4L2VideoDecoder::CommitInputBuffer(size_t size,
+                                         const int32_t buffer_id,
+                                         int64_t buffer_pts) {
+  MCIL_DEBUG_PRINT(": size[%zu], id[%d], pts[%ld]",
+                   size, buffer_id, buffer_pts);
+  MCIL_TRACE_EVENT1("V4L2VideoDecoder::CommitInputBuffer", "buffer_id",
+                    buffer_id);
+
+  if (!input_buffer_leased_ || !current_input_buffer_) {
+    MCIL_ERROR_PRINT(": no input buffer leased");
+    NOTIFY_ERROR(ILLEGAL_STATE);
     return false;
   }
+  input_buffer_leased_ = false;
+
+  if (!current_input_buffer_has_id_)
+    SetInputBufferId(buffer_id);
 
-  if (buffer_size > 0) {
-    memcpy(reinterpret_cast<uint8_t*>(input_buffer) + bytes_used,
-           buffer, buffer_size);
-    current_input_buffer_->SetBytesUsed(0, bytes_used + buffer_size);
+  if (!InputBufferHasRoom(size)) {
+    MCIL_ERROR_PRINT(": committed past the leased buffer, erroring");
+    NOTIFY_ERROR(UNREADABLE_INPUT);
+    return false;
   }
 
+  AddInputBytesUsed(size);
   return true;
 }
 
@@ -208,13 +247,34 @@ bool V4L2VideoDecoder::FlushInputBuffers() {
     return true;
   }
 
+  if (input_buffer_leased_) {
+    MCIL_ERROR_PRINT(": input buffer leased, commit it first");
+    return false;
+  }
+
+  // A buffer left without an id by a stalled lease holds no data either.
   const int32_t input_id = current_input_buffer_->GetBufferId();
-  if ((input_id >= 0) &&
+  if ((!current_input_buffer_has_id_ || (input_id >= 0)) &&
       (current_input_buffer_->GetBytesUsed(0) == 0)) {
     current_input_buffer_.reset();
     return true;
   }
 
+  if (input_ring_ != nullptr) {
+    size_t buffer_index = current_input_buffer_->BufferIndex();
+    size_t bytes_used = current_input_buffer_->GetBytesUsed(0);
+    // Empty buffers, e.g. the flush buffer, point at the ring start and
+    // take no ring space.
+    input_ring_starts_[buffer_index] =
+        current_input_in_ring_ ? current_ring_start_ : 0;
+    if (current_input_in_ring_ && (bytes_used > 0)) {
+      input_ring_ranges_.push_back(
+          {buffer_index, current_ring_start_, current_ring_start_ + bytes_used,
+           false});
+    }
+    current_input_in_ring_ = false;
+  }
+
   // Queue it.
   MCIL_DEBUG_PRINT(": Queuing buffer input_id=%d", input_id);
   input_ready_queue_.push(std::move(*current_input_buffer_));
@@ -225,6 +285,127 @@ bool V4L2VideoDecoder::FlushInputBuffers() {
   return (decoder_state_ != kDecoderError);
 }
 
+bool V4L2VideoDecoder::GetFreeInputBuffer() {
+  // Only input buffers can end the stall, decoded frames are left to the
+  // next device poll.
+  if (input_queue_->FreeBuffersCount() == 0)
+    DequeueReadyBuffers(V4L2Device::kOutputQueueReady);
+
+  current_input_buffer_ = input_queue_->GetFreeBuffer();
+  if (!current_input_buffer_) {
+    MCIL_DEBUG_PRINT(": stalled for input buffers");
+    return false;
+  }
+  current_input_buffer_has_id_ = false;
+  current_input_in_ring_ = false;
+  return true;
+}
+
+void V4L2VideoDecoder::SetInputBufferId(int32_t buffer_id) {
+  struct timeval timestamp = { .tv_sec = buffer_id };
+  current_input_buffer_->SetTimeStamp(timestamp);
+  current_input_buffer_->SetBufferId(buffer_id);
+  current_input_buffer_has_id_ = true;
+
+  if (buffer_id >= 0) {
+    FrameTimes& times = frame_times_[buffer_id % kFrameTimesCount];
+    times.buffer_id = buffer_id;
+    times.decode_time = std::chrono::steady_clock::now();
+    times.queue_time = MonotonicTime();
+  }
+}
+
+bool V4L2VideoDecoder::InputBufferHasRoom(size_t size) {
+  size_t bytes_used = current_input_buffer_->GetBytesUsed(0);
+  if (input_ring_ != nullptr) {
+    return !current_input_in_ring_ ||
+           InputRingFits(current_ring_start_, bytes_used + size);
+  }
+  return (bytes_used + size) <= current_input_buffer_->GetBufferSize(0);
+}
+
+uint8_t* V4L2VideoDecoder::GetInputBufferSpace(size_t size) {
+  size_t bytes_used = current_input_buffer_->GetBytesUsed(0);
+  if (input_ring_ != nullptr) {
+    if (!current_input_in_ring_ && !ReserveInputRing(size))
+      return nullptr;
+    return input_ring_ + current_ring_start_ + bytes_used;
+  }
+
+  size_t plane_size = current_input_buffer_->GetBufferSize(0);
+  if (size > (plane_size - bytes_used)) {
+    MCIL_ERROR_PRINT(": over-size frame, erroring");
+    NOTIFY_ERROR(UNREADABLE_INPUT);
+    return nullptr;
+  }
+
+  void* input_buffer = current_input_buffer_->GetPlaneBuffer(0);
+  if (input_buffer == nullptr) {
+    MCIL_ERROR_PRINT(": Error allocating input buffer");
+    return nullptr;
+  }
+  return reinterpret_cast<uint8_t*>(input_buffer) + bytes_used;
+}
+
+void V4L2VideoDecoder::AddInputBytesUsed(size_t size) {
+  size_t bytes_used = current_input_buffer_->GetBytesUsed(0) + size;
+  // Input ring buffers are only as long as their data.
+  if (input_ring_ != nullptr) {
+    current_input_buffer_->SetBufferSize(
+        0, std::max(bytes_used, input_ring_min_length_));
+  }
+  current_input_buffer_->SetBytesUsed(0, bytes_used);
+}
+
+bool V4L2VideoDecoder::InputRingFits(size_t start, size_t size) const {
+  // The device may require a longer buffer than the data, it only reads
+  // the bytes used though.
+  if ((start + std::max(size, input_ring_min_length_)) > input_ring_size_)
+    return false;
+
+  if (input_ring_ranges_.empty())
+    return true;
+
+  // In use from the oldest queued access unit up to the newest one.
+  size_t tail = input_ring_ranges_.front().start;
+  size_t head = input_ring_ranges_.back().end;
+  if (head > tail)
+    return (start >= head) || ((start + size) <= tail);
+  return (start >= head) && ((start + size) <= tail);
+}
+
+bool V4L2VideoDecoder::ReserveInputRing(size_t size) {
+  for (int32_t attempt = 0; attempt < 2; ++attempt) {
+    size_t start = 0;
+    if (!input_ring_ranges_.empty()) {
+      start = (input_ring_ranges_.back().end + kInputRingAlignment - 1) &
+              ~static_cast<size_t>(kInputRingAlignment - 1);
+    }
+
+    if (!InputRingFits(start, size))
+      start = 0;
+    if (InputRingFits(start, size)) {
+      current_ring_start_ = start;
+      current_input_in_ring_ = true;
+      return true;
+    }
+
+    if (input_ring_ranges_.empty()) {
+      MCIL_ERROR_PRINT(": over-size frame [%zu], ring [%zu], erroring",
+                       size, input_ring_size_);
+      NOTIFY_ERROR(UNREADABLE_INPUT);
+      return false;
+    }
+
+    // Ring space comes back with the input buffers.
+    if (attempt == 0)
+      DequeueReadyBuffers(V4L2Device::kOutputQueueReady);
+  }
+
+  MCIL_DEBUG_PRINT(": stalled for input ring space");
+  return false;
+}
+
 bool V4L2VideoDecoder::DidFlushBuffersDone() {
   if (current_input_buffer_) {
     MCIL_DEBUG_PRINT(": Current input buffer != -1");
@@ -264,6 +445,7 @@ void V4L2VideoDecoder::EnqueueBuffers() {
 
       if (coded_size_.IsEmpty() || (input_queue_->IsStreaming() == false)) {
         MCIL_DEBUG_PRINT(": Nothing to flush. Notify flush done directly");
+        MCIL_TRACE_INSTANT("V4L2VideoDecoder::FlushDone");
         client_->NotifyFlushDone();
         flush_handled = true;
       } else if (decoder_cmd_supported_) {
@@ -304,6 +486,11 @@ void V4L2VideoDecoder::EnqueueBuffers() {
 
   client_->CheckGLFences();
   while (auto buffer_opt = output_queue_->GetFreeBuffer()) {
+    // Free buffers come lowest index first, the rest waits for the client
+    // to import this one.
+    if ((buffer_opt->Memory() == V4L2_MEMORY_DMABUF) &&
+        !imported_frames_[buffer_opt->BufferIndex()])
+      break;
     if (!EnqueueOutputBuffer(std::move(*buffer_opt)))
       return;
   }
@@ -324,14 +511,28 @@ void V4L2VideoDecoder::EnqueueBuffers() {
 }
 
 void V4L2VideoDecoder::DequeueBuffers() {
-  while (input_queue_->QueuedBuffersCount() > 0) {
-    if (!DequeueInputBuffer())
-      break;
+  DequeueReadyBuffers(V4L2Device::kAllQueuesReady);
+}
+
+void V4L2VideoDecoder::DequeueReadyBuffers(uint32_t ready_queues) {
+  if ((ready_queues & V4L2Device::kOutputQueueReady) != 0) {
+    while (input_queue_->QueuedBuffersCount() > 0) {
+      if (!DequeueInputBuffer())
+        break;
+    }
   }
 
-  while (output_queue_->QueuedBuffersCount() > 0) {
-    if (!DequeueOutputBuffer())
-      break;
+  if ((ready_queues & V4L2Device::kCaptureQueueReady) != 0) {
+    while (output_queue_->QueuedBuffersCount() > 0) {
+      if (!DequeueOutputBuffer())
+        break;
+    }
+  }
+
+  if (!output_batch_.empty()) {
+    MCIL_DEBUG_PRINT(": Send [%zu] buffers", output_batch_.size());
+    client_->SendBuffersToClient(output_batch_);
+    output_batch_.clear();
   }
 
   client_->NotifyFlushDoneIfNeeded();
@@ -343,6 +544,8 @@ void V4L2VideoDecoder::ReusePictureBuffer(int32_t pic_buffer_id) {
 
 void V4L2VideoDecoder::RunDecodeBufferTask(bool event_pending, bool) {
   MCIL_DEBUG_PRINT(": event_pending[%d]", event_pending);
+  MCIL_TRACE_EVENT1("V4L2VideoDecoder::RunDecodeBufferTask", "event_pending",
+                    event_pending);
 
   bool resolution_change_pending = false;
   if (event_pending) {
@@ -360,7 +563,10 @@ void V4L2VideoDecoder::RunDecodeBufferTask(bool event_pending, bool) {
     }
   }
 
-  DequeueBuffers();
+  // Only touch the queues the device poll found ready. Buffers that became
+  // ready since then make the next poll return right away.
+  DequeueReadyBuffers(
+      poll_ready_queues_.exchange(0, std::memory_order_acquire));
   EnqueueBuffers();
 
   // Clear the interrupt fd.
@@ -377,8 +583,7 @@ void V4L2VideoDecoder::RunDecodeBufferTask(bool event_pending, bool) {
   }
 
   // Queue the DevicePollTask() now.
-  device_poll_thread_.PostTask(std::bind(&V4L2VideoDecoder::DevicePollTask,
-                                         this, poll_device));
+  ScheduleDevicePollTask(poll_device);
 
   client_->ScheduleDecodeBufferTaskIfNeeded();
   if (resolution_change_pending)
@@ -421,7 +626,11 @@ bool V4L2VideoDecoder::AllocateOutputBuffers(
     return false;
   }
 
-  if (output_queue_->AllocateBuffers(buffer_count, V4L2_MEMORY_MMAP) == 0) {
+  // Imported buffers decode straight into the client dmabufs, no copy or
+  // export of driver allocated buffers.
+  enum v4l2_memory memory = (output_mode_ == OUTPUT_IMPORT) ?
+      V4L2_MEMORY_DMABUF : V4L2_MEMORY_MMAP;
+  if (output_queue_->AllocateBuffers(buffer_count, memory) == 0) {
     MCIL_ERROR_PRINT(": Failed to request buffers!");
     NOTIFY_ERROR(PLATFORM_FAILURE);
     return false;
@@ -435,6 +644,10 @@ bool V4L2VideoDecoder::AllocateOutputBuffers(
     return false;
   }
 
+  imported_frames_.clear();
+  if (memory == V4L2_MEMORY_DMABUF)
+    imported_frames_.resize(buffer_count);
+
   size_t i = 0;
   while (auto buffer = output_queue_->GetFreeBufferPtr()) {
     if(i < buffer_count) {
@@ -451,6 +664,31 @@ bool V4L2VideoDecoder::AllocateOutputBuffers(
   return true;
 }
 
+bool V4L2VideoDecoder::ImportBufferForPicture(
+    int32_t pic_buffer_id, scoped_refptr<VideoFrame> frame) {
+  if ((pic_buffer_id < 0) ||
+      (static_cast<size_t>(pic_buffer_id) >= imported_frames_.size())) {
+    MCIL_ERROR_PRINT(": Invalid buffer index [%d], imported buffers [%zu]",
+                     pic_buffer_id, imported_frames_.size());
+    NOTIFY_ERROR(INVALID_ARGUMENT);
+    return false;
+  }
+
+  if (!frame || (frame->dmabuf_fds.size() < output_queue_->PlanesCount())) {
+    MCIL_ERROR_PRINT(": Buffer index [%d] has [%zu] dmabufs, [%zu] planes "
+                     "required", pic_buffer_id,
+                     frame ? frame->dmabuf_fds.size() : 0,
+                     output_queue_->PlanesCount());
+    NOTIFY_ERROR(INVALID_ARGUMENT);
+    return false;
+  }
+
+  MCIL_DEBUG_PRINT(": buffer index[%d] fds[%zu]",
+                   pic_buffer_id, frame->dmabuf_fds.size());
+  imported_frames_[pic_buffer_id] = std::move(frame);
+  return true;
+}
+
 bool V4L2VideoDecoder::CanCreateEGLImageFrom(VideoPixelFormat pixel_format) {
   if (device_) {
     auto fourcc = Fourcc::FromVideoPixelFormat(pixel_format);
@@ -464,6 +702,17 @@ bool V4L2VideoDecoder::CanCreateEGLImageFrom(VideoPixelFormat pixel_format) {
 void V4L2VideoDecoder::OnEGLImagesCreationCompleted() {
 }
 
+bool V4L2VideoDecoder::GetStats(DecoderStats* stats) {
+  if (stats == nullptr)
+    return false;
+
+  stats->input_wait = input_wait_histogram_.Snapshot();
+  stats->input_device = input_device_histogram_.Snapshot();
+  stats->decode = decode_histogram_.Snapshot();
+  stats->total = total_histogram_.Snapshot();
+  return true;
+}
+
 #if defined (ENABLE_REACQUIRE)
 void V4L2VideoDecoder::SetResolutionChangeCb(ResolutionChangeCb cb) {
   resolution_change_cb_ = std::move(cb);
@@ -471,18 +720,47 @@ void V4L2VideoDecoder::SetResolutionChangeCb(ResolutionChangeCb cb) {
 #endif
 
 void V4L2VideoDecoder::DevicePollTask(bool poll_device) {
+  MCIL_TRACE_EVENT1("V4L2VideoDecoder::DevicePollTask", "poll_device",
+                    poll_device);
+
   bool event_pending = false;
-  if (!device_->Poll(poll_device, &event_pending)) {
+  uint32_t ready_queues = 0;
+  if (!device_->Poll(poll_device, &event_pending, &ready_queues)) {
     MCIL_ERROR_PRINT(": Failed during poll");
     NOTIFY_ERROR(PLATFORM_FAILURE);
     return;
   }
 
+  OnDevicePollDone(event_pending, ready_queues);
+}
+
+void V4L2VideoDecoder::OnDevicePollDone(bool event_pending,
+                                        uint32_t ready_queues) {
+  poll_ready_queues_.fetch_or(ready_queues, std::memory_order_release);
+  // The shared poller thread serves every codec of the process, it must
+  // not service this one nor wait for its client.
+  if ((direct_dispatch_lock_ != nullptr) && (shared_poller_ == nullptr) &&
+      RunDirectDispatch(event_pending))
+    return;
+
   // All processing should happen on DecodeBufferTask(), since we shouldn't
   // touch decoder state from this thread.
   client_->NotifyDecodeBufferTask(event_pending, false);
 }
 
+bool V4L2VideoDecoder::RunDirectDispatch(bool event_pending) {
+  // The client may hold its lock for a while, even while stopping the
+  // device poll, so never wait for it. The caller takes the thread hop
+  // instead.
+  std::unique_lock<std::recursive_mutex> lock(*direct_dispatch_lock_,
+                                              std::try_to_lock);
+  if (!lock.owns_lock())
+    return false;
+
+  RunDecodeBufferTask(event_pending, false);
+  return true;
+}
+
 bool V4L2VideoDecoder::IsDecoderCmdSupported() {
   struct v4l2_decoder_cmd cmd;
   memset(&cmd, 0, sizeof(cmd));
@@ -496,6 +774,8 @@ bool V4L2VideoDecoder::IsDecoderCmdSupported() {
 }
 
 bool V4L2VideoDecoder::SendDecoderCmdStop() {
+  MCIL_TRACE_EVENT("V4L2VideoDecoder::SendDecoderCmdStop");
+
   struct v4l2_decoder_cmd cmd;
   memset(&cmd, 0, sizeof(cmd));
   cmd.cmd = V4L2_DEC_CMD_STOP;
@@ -525,6 +805,18 @@ bool V4L2VideoDecoder::CheckConfig(const DecoderConfig* config) {
   decoder_config_.profile = config->profile;
   decoder_config_.outputMode = config->outputMode;
 
+  size_t input_ring_size = 0;
+  uint8_t* input_ring = client_->InputRing(&input_ring_size);
+  if (input_ring != nullptr) {
+    const uintptr_t page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    if ((reinterpret_cast<uintptr_t>(input_ring) % page_size) != 0) {
+      MCIL_ERROR_PRINT(": input ring %p is not page aligned", input_ring);
+      return false;
+    }
+    input_ring_ = input_ring;
+    input_ring_size_ = input_ring_size;
+  }
+
   input_format_fourcc_ =
       V4L2Device::VideoCodecProfileToV4L2PixFmt(config->profile);
 
@@ -568,7 +860,10 @@ bool V4L2VideoDecoder::SetupFormats() {
   Size min_resolution;
   device_->GetSupportedResolution(
       input_format_fourcc_, &min_resolution, &max_resolution);
-  if ((max_resolution.width > 1920) && (max_resolution.height > 1088))
+  // With the input ring, buffers are only as large as their access units.
+  if (input_ring_ != nullptr)
+    input_size = kInputRingMinBufferSize;
+  else if ((max_resolution.width > 1920) && (max_resolution.height > 1088))
     input_size = kInputBufferMaxSizeFor4k;
   else
     input_size = kInputBufferMaxSizeFor1080p;
@@ -599,6 +894,14 @@ bool V4L2VideoDecoder::SetupFormats() {
   format.fmt.pix_mp.num_planes = 1;
   IOCTL_OR_ERROR_RETURN_FALSE(VIDIOC_S_FMT, &format);
 
+  // The driver may raise it, every queued buffer must be that long.
+  input_ring_min_length_ = format.fmt.pix_mp.plane_fmt[0].sizeimage;
+  if ((input_ring_ != nullptr) && (input_ring_min_length_ > input_ring_size_)) {
+    MCIL_ERROR_PRINT(": input ring [%zu] smaller than a buffer [%zu]",
+                     input_ring_size_, input_ring_min_length_);
+    return false;
+  }
+
   // We have to set up the format for output, because the driver may not allow
   // changing it once we start streaming; whether it can support our chosen
   // output format or not may depend on the input format.
@@ -665,12 +968,17 @@ int32_t V4L2VideoDecoder::DequeueResolutionChangeEvent() {
 }
 
 bool V4L2VideoDecoder::AllocateInputBuffers() {
-  if (input_queue_->AllocateBuffers(kInputBufferCount,
-                                    V4L2_MEMORY_MMAP) == 0) {
+  enum v4l2_memory memory = (input_ring_ != nullptr) ?
+      V4L2_MEMORY_USERPTR : V4L2_MEMORY_MMAP;
+  if (input_queue_->AllocateBuffers(kInputBufferCount, memory) == 0) {
     MCIL_ERROR_PRINT(": Failed allocating input buffers");
     return false;
   }
 
+  input_ring_starts_.assign(input_queue_->AllocatedBuffersCount(), 0);
+  input_ring_ranges_.clear();
+  current_input_in_ring_ = false;
+
   MCIL_DEBUG_PRINT(": allocated[%lu]", input_queue_->AllocatedBuffersCount());
   return true;
 }
@@ -700,6 +1008,7 @@ bool V4L2VideoDecoder::DestroyOutputBuffers() {
     return true;
 
   bool success = true;
+  imported_frames_.clear();
   if (!output_queue_->DeallocateBuffers()) {
     MCIL_ERROR_PRINT(": Failed deallocating output buffers");
     NOTIFY_ERROR(PLATFORM_FAILURE);
@@ -804,9 +1113,9 @@ bool V4L2VideoDecoder::EnqueueInputBuffer(V4L2WritableBufferRef buffer) {
       ret = std::move(buffer).QueueMMap();
       break;
     case V4L2_MEMORY_USERPTR: {
-      std::vector<void*> user_ptrs;
-      for (size_t i = 0; i < buffer.PlanesCount(); ++i)
-        user_ptrs.push_back(buffer.GetPlaneBuffer(i));
+      // Only used with the input ring.
+      std::vector<void*> user_ptrs = {
+          input_ring_ + input_ring_starts_[buffer_index]};
       ret = std::move(buffer).QueueUserPtr(user_ptrs);
       break;
     }
@@ -820,6 +1129,12 @@ bool V4L2VideoDecoder::EnqueueInputBuffer(V4L2WritableBufferRef buffer) {
     return false;
   }
 
+  FrameTimes* times = FindFrameTimes(buffer_id);
+  if (times != nullptr) {
+    times->queue_time = std::chrono::steady_clock::now();
+    input_wait_histogram_.Record(times->decode_time, times->queue_time);
+  }
+
   MCIL_DEBUG_PRINT(": buffer index[%ld] id[%d], size[%ld]",
                    buffer_index, buffer_id, bytes_used);
   return true;
@@ -835,9 +1150,31 @@ bool V4L2VideoDecoder::DequeueInputBuffer() {
     MCIL_DEBUG_PRINT(": Dequeue input buffer. Waiting");
     return false;
   }
+
+  if (input_ring_ != nullptr)
+    ReleaseInputRing(ret.second->BufferIndex());
+
+  int32_t buffer_id = static_cast<int32_t>(ret.second->GetTimeStamp().tv_sec);
+  FrameTimes* times = FindFrameTimes(buffer_id);
+  if ((times != nullptr) && (times->queue_time != MonotonicTime())) {
+    input_device_histogram_.Record(times->queue_time,
+                                   std::chrono::steady_clock::now());
+  }
   return true;
 }
 
+void V4L2VideoDecoder::ReleaseInputRing(size_t buffer_index) {
+  for (auto& range : input_ring_ranges_) {
+    if ((range.buffer_index == buffer_index) && !range.released) {
+      range.released = true;
+      break;
+    }
+  }
+
+  while (!input_ring_ranges_.empty() && input_ring_ranges_.front().released)
+    input_ring_ranges_.pop_front();
+}
+
 bool V4L2VideoDecoder::EnqueueOutputBuffer(V4L2WritableBufferRef buffer) {
   size_t buffer_index = buffer.BufferIndex();
   bool ret = false;
@@ -852,6 +1189,9 @@ bool V4L2VideoDecoder::EnqueueOutputBuffer(V4L2WritableBufferRef buffer) {
       ret = std::move(buffer).QueueUserPtr(user_ptrs);
       break;
     }
+    case V4L2_MEMORY_DMABUF:
+      ret = std::move(buffer).QueueDMABuf(imported_frames_[buffer_index]);
+      break;
     default:
       return false;
   }
@@ -880,31 +1220,42 @@ bool V4L2VideoDecoder::DequeueOutputBuffer() {
     return false;
   }
 
+  const MonotonicTime now = std::chrono::steady_clock::now();
+
   ReadableBufferRef buffer(std::move(ret.second));
   if (buffer->GetBytesUsed(0) > 0) {
     size_t index = buffer->BufferIndex();
     int32_t buffer_id = static_cast<int32_t>(buffer->GetTimeStamp().tv_sec);
+    FrameTimes* times = FindFrameTimes(buffer_id);
+    if (times != nullptr) {
+      if (times->queue_time != MonotonicTime())
+        decode_histogram_.Record(times->queue_time, now);
+      total_histogram_.Record(times->decode_time, now);
+    }
+
     MCIL_DEBUG_PRINT(": Send buffer: index[%ld], id[%d]", index, buffer_id);
-    client_->SendBufferToClient(index, buffer_id, buffer);
+    if (batched_output_)
+      output_batch_.push_back({index, buffer_id, buffer});
+    else
+      client_->SendBufferToClient(index, buffer_id, buffer);
   }
 
-  if (start_time_ == ChronoTime())
-    start_time_ = std::chrono::system_clock::now();
+  if (start_time_ == MonotonicTime())
+    start_time_ = now;
 
   frames_per_sec_++;
-  std::chrono::duration<double> time_past =
-      std::chrono::system_clock::now() - start_time_;
-  if (time_past >= std::chrono::seconds(1)) {
+  if ((now - start_time_) >= std::chrono::seconds(1)) {
     current_secs_++;
     MCIL_INFO_PRINT(": Decoder @ %d secs => %d fps",
                     current_secs_, frames_per_sec_);
-    start_time_ = std::chrono::system_clock::now();
+    start_time_ = now;
     frames_per_sec_ = 0;
   }
 
   if (buffer->IsLast()) {
     MCIL_DEBUG_PRINT(": Got last output buffer. Waiting last buffer[%d]",
                      flush_awaiting_last_output_buffer_);
+    MCIL_TRACE_INSTANT("V4L2VideoDecoder::LastOutputBuffer");
     if (flush_awaiting_last_output_buffer_) {
        if (!SendDecoderCmdStart())
          return false;
@@ -915,28 +1266,52 @@ bool V4L2VideoDecoder::DequeueOutputBuffer() {
 }
 
 bool V4L2VideoDecoder::StartDevicePoll() {
-  if (device_poll_thread_.IsRunning())
+  if (IsDevicePollRunning())
     return true;
 
   client_->OnStartDevicePoll();
 
-  device_poll_thread_.Start();
-  device_poll_thread_.PostTask(std::bind(&V4L2VideoDecoder::DevicePollTask,
-                                         this, false));
+  V4L2DevicePoller* poller = V4L2DevicePoller::Get();
+  if ((poller != nullptr) &&
+      poller->Register(device_,
+                       std::bind(&V4L2VideoDecoder::OnDevicePollDone, this,
+                                 std::placeholders::_1,
+                                 std::placeholders::_2))) {
+    shared_poller_ = poller;
+  } else {
+    device_poll_loop_.Start(std::bind(&V4L2VideoDecoder::DevicePollTask, this,
+                                      std::placeholders::_1));
+  }
+
+  ScheduleDevicePollTask(false);
+
+  // The poll stopped last may have been stopped before it ever ran, or
+  // from a direct dispatch, so nothing is left to service the buffers still
+  // queued. Make the new poll do it right away.
+  if (!device_->SetDevicePollInterrupt()) {
+    MCIL_ERROR_PRINT(": SetDevicePollInterrupt failed");
+    NOTIFY_ERROR(PLATFORM_FAILURE);
+    return false;
+  }
 
   return true;
 }
 
 bool V4L2VideoDecoder::StopDevicePoll() {
-  if (!device_poll_thread_.IsRunning())
+  if (!IsDevicePollRunning())
     return true;
 
-  if (!device_->SetDevicePollInterrupt()) {
-    MCIL_DEBUG_PRINT(": SetDevicePollInterrupt(): failed");
-    return false;
-  }
+  if (shared_poller_ != nullptr) {
+    shared_poller_->Unregister(device_.get());
+    shared_poller_ = nullptr;
+  } else {
+    if (!device_->SetDevicePollInterrupt()) {
+      MCIL_DEBUG_PRINT(": SetDevicePollInterrupt(): failed");
+      return false;
+    }
 
-  device_poll_thread_.Stop();
+    device_poll_loop_.Stop();
+  }
   client_->OnStopDevicePoll();
 
   if (!device_->ClearDevicePollInterrupt()) {
@@ -947,6 +1322,20 @@ bool V4L2VideoDecoder::StopDevicePoll() {
   return true;
 }
 
+bool V4L2VideoDecoder::IsDevicePollRunning() {
+  return (shared_poller_ != nullptr) || device_poll_loop_.IsRunning();
+}
+
+void V4L2VideoDecoder::ScheduleDevicePollTask(bool poll_device) {
+  if (shared_poller_ != nullptr) {
+    if (!shared_poller_->Arm(device_.get(), poll_device))
+      NOTIFY_ERROR(PLATFORM_FAILURE);
+    return;
+  }
+
+  device_poll_loop_.Arm(poll_device);
+}
+
 bool V4L2VideoDecoder::StopInputStream() {
   if ((input_queue_ == nullptr) || (input_queue_->IsStreaming() == false)) {
     return true;
@@ -961,6 +1350,7 @@ bool V4L2VideoDecoder::StopInputStream() {
   // Reset accounting info for input.
   while (!input_ready_queue_.empty())
     input_ready_queue_.pop();
+  input_ring_ranges_.clear();
 
   return true;
 }
@@ -983,6 +1373,8 @@ bool V4L2VideoDecoder::StopOutputStream() {
 }
 
 void V4L2VideoDecoder::StartResolutionChange() {
+  MCIL_TRACE_EVENT("V4L2VideoDecoder::ResolutionChange");
+
   if (!(StopDevicePoll() && StopOutputStream()))
     return;
 
@@ -1018,6 +1410,8 @@ void V4L2VideoDecoder::FinishResolutionChange() {
     NOTIFY_ERROR(PLATFORM_FAILURE);
     return;
   }
+  MCIL_TRACE_INSTANT1("V4L2VideoDecoder::NewCodedSize", "height",
+                      coded_size_.height);
 
   #if defined (ENABLE_REACQUIRE)
   bool ignore_resolution_change = coded_size_.IsEmpty();
@@ -1028,4 +1422,13 @@ void V4L2VideoDecoder::FinishResolutionChange() {
   StartDevicePoll();
 }
 
+V4L2VideoDecoder::FrameTimes* V4L2VideoDecoder::FindFrameTimes(
+    int32_t buffer_id) {
+  if (buffer_id < 0)
+    return nullptr;
+
+  FrameTimes& times = frame_times_[buffer_id % kFrameTimesCount];
+  return (times.buffer_id == buffer_id) ? &times : nullptr;
+}
+
 }  // namespace mcil
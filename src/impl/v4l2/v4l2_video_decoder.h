@@ -9,16 +9,21 @@
 #ifndef SRC_IMPL_V4L2_V4L2_VIDEO_DECODER_H_
 #define SRC_IMPL_V4L2_V4L2_VIDEO_DECODER_H_
 
-#include "base/thread.h"
+#include <deque>
+
+#include "base/latency_histogram.h"
 #include "base/video_decoder.h"
+#include "base/video_decoder_client.h"
 
 #include "v4l2/v4l2_buffers.h"
+#include "v4l2/v4l2_device_poll_loop.h"
 #include "v4l2/v4l2_utils.h"
 
 namespace mcil {
 
 class Fourcc;
 class V4L2Device;
+class V4L2DevicePoller;
 
 class V4L2VideoDecoder : public VideoDecoder {
  public:
@@ -40,6 +45,9 @@ class V4L2VideoDecoder : public VideoDecoder {
   virtual bool DecodeBuffer(const void* buffer, size_t buffer_size,
                             const int32_t buffer_id, int64_t buffer_pts)
       override;
+  virtual void* AcquireInputBuffer(size_t min_size) override;
+  virtual bool CommitInputBuffer(size_t size, const int32_t buffer_id,
+                                 int64_t buffer_pts) override;
   virtual bool FlushInputBuffers() override;
   virtual bool DidFlushBuffersDone() override;
 
@@ -56,14 +64,22 @@ class V4L2VideoDecoder : public VideoDecoder {
   virtual bool AllocateOutputBuffers(
       uint32_t buffer_count, std::vector<WritableBufferRef*> & output_buffers)
       override;
+  virtual bool ImportBufferForPicture(int32_t pic_buffer_id,
+                                      scoped_refptr<VideoFrame> frame)
+      override;
   virtual bool CanCreateEGLImageFrom(VideoPixelFormat pixel_format) override;
   virtual void OnEGLImagesCreationCompleted() override;
   virtual void RunDecoderPostTask(PostTaskType task, bool value) override {}
+  virtual bool GetStats(DecoderStats* stats) override;
   #if defined (ENABLE_REACQUIRE)
   void SetResolutionChangeCb(ResolutionChangeCb cb) override;
   #endif
 
   void DevicePollTask(bool poll_device);
+  void OnDevicePollDone(bool event_pending, uint32_t ready_queues);
+  // Runs RunDecodeBufferTask() on the device poll thread, unless the client
+  // lock is taken. See DirectDispatchLock().
+  bool RunDirectDispatch(bool event_pending);
 
  protected:
   // These are rather subjectively tuned.
@@ -71,8 +87,21 @@ class V4L2VideoDecoder : public VideoDecoder {
     kInputBufferCount = 8,
     kInputBufferMaxSizeFor1080p = 1024 * 1024,
     kInputBufferMaxSizeFor4k = 4 * kInputBufferMaxSizeFor1080p,
+    // Requested input buffer size with the input ring.
+    kInputRingMinBufferSize = 4096,
+    // Keeps every access unit in the input ring cache line aligned.
+    kInputRingAlignment = 64,
     kDpbOutputBufferExtraCount = 5,
     kDpbOutputBufferExtraCountForImageProcessor = 1,
+    // Must exceed the number of buffer ids in flight in input and DPB.
+    kFrameTimesCount = 64,
+  };
+
+  // Timestamps of one input buffer id, taken on the decoder thread.
+  struct FrameTimes {
+    int32_t buffer_id = -1;
+    MonotonicTime decode_time;
+    MonotonicTime queue_time;
   };
 
   virtual bool IsDecoderCmdSupported();
@@ -104,9 +133,13 @@ class V4L2VideoDecoder : public VideoDecoder {
 
   virtual bool EnqueueOutputBuffer(V4L2WritableBufferRef buffer);
   virtual bool DequeueOutputBuffer();
+  // Only dequeues from the queues in |ready_queues|.
+  void DequeueReadyBuffers(uint32_t ready_queues);
 
   virtual bool StartDevicePoll();
   virtual bool StopDevicePoll();
+  bool IsDevicePollRunning();
+  void ScheduleDevicePollTask(bool poll_device);
 
   virtual bool StopInputStream();
   virtual bool StopOutputStream();
@@ -114,9 +147,50 @@ class V4L2VideoDecoder : public VideoDecoder {
   virtual void StartResolutionChange();
   virtual void FinishResolutionChange();
 
+  // Makes a free input buffer |current_input_buffer_|.
+  bool GetFreeInputBuffer();
+  void SetInputBufferId(int32_t buffer_id);
+  bool InputBufferHasRoom(size_t size);
+  // Returns where the next |size| bytes of |current_input_buffer_| go, or
+  // nullptr when stalled or on error.
+  uint8_t* GetInputBufferSpace(size_t size);
+  void AddInputBytesUsed(size_t size);
+
+  // Input ring, used when the client provides one. Whether |size| bytes
+  // at |start| are free and the queued buffer stays inside the ring.
+  bool InputRingFits(size_t start, size_t size) const;
+  bool ReserveInputRing(size_t size);
+  void ReleaseInputRing(size_t buffer_index);
+
+  FrameTimes* FindFrameTimes(int32_t buffer_id);
+
   scoped_refptr<V4L2Device> device_;
 
   Optional<V4L2WritableBufferRef> current_input_buffer_;
+  // Whether |current_input_buffer_| has its buffer id set. A lease that
+  // stalls keeps the buffer without one until the next commit.
+  bool current_input_buffer_has_id_ = false;
+  // Set between AcquireInputBuffer() and CommitInputBuffer().
+  bool input_buffer_leased_ = false;
+
+  // Ring space of one queued input buffer.
+  struct InputRingRange {
+    size_t buffer_index;
+    size_t start;
+    size_t end;
+    bool released;
+  };
+
+  uint8_t* input_ring_ = nullptr;
+  size_t input_ring_size_ = 0;
+  size_t input_ring_min_length_ = 0;
+  // Oldest first, released ones are reclaimed once they reach the front.
+  std::deque<InputRingRange> input_ring_ranges_;
+  // Ring offset of each input buffer, by buffer index.
+  std::vector<size_t> input_ring_starts_;
+  size_t current_ring_start_ = 0;
+  // Whether |current_input_buffer_| has its ring space reserved.
+  bool current_input_in_ring_ = false;
 
   scoped_refptr<V4L2Queue> input_queue_;
   scoped_refptr<V4L2Queue> output_queue_;
@@ -124,6 +198,8 @@ class V4L2VideoDecoder : public VideoDecoder {
   std::queue<V4L2WritableBufferRef> input_ready_queue_;
 
   OutputMode output_mode_ = OUTPUT_ALLOCATE;
+  // Client dmabufs of the output buffers, by buffer index, in OUTPUT_IMPORT.
+  std::vector<scoped_refptr<VideoFrame>> imported_frames_;
 
   bool decoder_cmd_supported_ = false;
   bool flush_awaiting_last_output_buffer_ = false;
@@ -142,18 +218,37 @@ class V4L2VideoDecoder : public VideoDecoder {
   DecoderConfig decoder_config_ = {0};
 
   VideoDecoderClient* client_ = nullptr;
+  // Output buffers dequeued in this wake up, when the client takes them in
+  // batches.
+  bool batched_output_ = false;
+  std::vector<DecodedBuffer> output_batch_;
 
-  ChronoTime start_time_;
+  MonotonicTime start_time_;
   uint32_t frames_per_sec_ = 0;
   uint32_t current_secs_ = 0;
 
+  FrameTimes frame_times_[kFrameTimesCount];
+  LatencyHistogram input_wait_histogram_;
+  LatencyHistogram input_device_histogram_;
+  LatencyHistogram decode_histogram_;
+  LatencyHistogram total_histogram_;
+
   #if defined (ENABLE_REACQUIRE)
   ResolutionChangeCb resolution_change_cb_ = nullptr;
   #endif
 
   std::atomic<uint32_t> enqueued_output_buffers_{0};
 
-  Thread device_poll_thread_;
+  V4L2DevicePollLoop device_poll_loop_;
+  // Set instead of running |device_poll_loop_| when the device is polled
+  // by the shared V4L2DevicePoller.
+  V4L2DevicePoller* shared_poller_ = nullptr;
+  // Client lock held while servicing the device on the poll thread, when
+  // the client opted in to direct dispatch.
+  std::recursive_mutex* direct_dispatch_lock_ = nullptr;
+  // Ready queues reported by the polls completed since the last
+  // RunDecodeBufferTask().
+  std::atomic<uint32_t> poll_ready_queues_{0};
 
   std::atomic<CodecState> decoder_state_{kUninitialized};
 };
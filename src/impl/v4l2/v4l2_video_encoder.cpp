@@ -10,8 +10,10 @@
 
 #include "base/fourcc.h"
 #include "base/log.h"
+#include "base/trace_event.h"
 #include "base/video_encoder_client.h"
 #include "v4l2/v4l2_device.h"
+#include "v4l2/v4l2_device_poller.h"
 #include "v4l2/v4l2_queue.h"
 
 namespace mcil {
@@ -36,14 +38,15 @@ SupportedProfiles V4L2VideoEncoder::GetSupportedProfiles() {
 V4L2VideoEncoder::InputFrameInfo::InputFrameInfo(
     scoped_refptr<VideoFrame> frame,
     bool force_keyframe)
-    : frame(std::move(frame)), force_keyframe(force_keyframe) {}
+    : frame(std::move(frame)), force_keyframe(force_keyframe),
+      encode_time(std::chrono::steady_clock::now()) {}
 
 V4L2VideoEncoder::V4L2VideoEncoder()
  : VideoEncoder(),
    device_(V4L2Device::Create(V4L2_ENCODER)),
    input_memory_type_(V4L2_MEMORY_MMAP),
    output_memory_type_(V4L2_MEMORY_MMAP),
-   device_poll_thread_("V4L2EncoderDevicePollThread"),
+   device_poll_loop_("V4L2EncoderDevicePollThread"),
    encoder_state_(kUninitialized) {
 }
 
@@ -63,6 +66,8 @@ bool V4L2VideoEncoder::Initialize(const EncoderConfig* config,
     MCIL_ERROR_PRINT(" Delegate not provided");
     return false;
   }
+  batched_output_ = client_->UseBatchedOutput();
+  direct_dispatch_lock_ = client_->DirectDispatchLock();
 
   Size input_visible_size(config->width, config->height);
   input_visible_rect_ = Rect(input_visible_size);
@@ -160,7 +165,7 @@ void V4L2VideoEncoder::Destroy() {
   DestroyOutputBuffers();
 
   device_ = nullptr;
-  start_time_ = ChronoTime();
+  start_time_ = MonotonicTime();
 }
 
 bool V4L2VideoEncoder::IsFlushSupported() {
@@ -170,12 +175,22 @@ bool V4L2VideoEncoder::IsFlushSupported() {
 bool V4L2VideoEncoder::EncodeFrame(scoped_refptr<VideoFrame> frame,
                                    bool force_keyframe) {
   MCIL_DEBUG_PRINT(": force_keyframe[%d]", force_keyframe);
+  MCIL_TRACE_EVENT1("V4L2VideoEncoder::EncodeFrame", "force_keyframe",
+                    force_keyframe);
 
   if (encoder_state_ == kEncoderError) {
     MCIL_DEBUG_PRINT(" early out: kError state");
     return false;
   }
 
+  if (frame && (input_memory_type_ == V4L2_MEMORY_DMABUF) &&
+      (frame->dmabuf_fds.size() < InputPlanesCount())) {
+    MCIL_ERROR_PRINT(" Frame has [%zu] dmabufs, [%zu] planes required",
+                     frame->dmabuf_fds.size(), InputPlanesCount());
+    NOTIFY_ERROR(kInvalidArgumentError);
+    return false;
+  }
+
   if (frame && (input_buffer_created_ == false) &&
       (CreateInputBuffers() == false))
     return false;
@@ -197,6 +212,7 @@ bool V4L2VideoEncoder::FlushFrames() {
     return false;
   }
 
+  MCIL_TRACE_INSTANT("V4L2VideoEncoder::FlushFrames");
   encoder_input_queue_.emplace(nullptr, false);
   EnqueueBuffers();
 
@@ -235,12 +251,30 @@ bool V4L2VideoEncoder::UpdateEncodingParams(
 }
 
 bool V4L2VideoEncoder::StartDevicePoll() {
-  if (device_poll_thread_.IsRunning())
+  if (IsDevicePollRunning())
     return true;
 
-  device_poll_thread_.Start();
-  device_poll_thread_.PostTask(std::bind(&V4L2VideoEncoder::DevicePollTask,
-                                         this, false));
+  V4L2DevicePoller* poller = V4L2DevicePoller::Get();
+  if ((poller != nullptr) &&
+      poller->Register(device_,
+                       std::bind(&V4L2VideoEncoder::OnDevicePollDone, this,
+                                 std::placeholders::_1,
+                                 std::placeholders::_2))) {
+    shared_poller_ = poller;
+  } else {
+    device_poll_loop_.Start(std::bind(&V4L2VideoEncoder::DevicePollTask, this,
+                                      std::placeholders::_1));
+  }
+
+  ScheduleDevicePollTask(false);
+
+  // The poll stopped last may have been stopped before it ever ran, or
+  // from a direct dispatch, so nothing is left to service the buffers still
+  // queued. Make the new poll do it right away.
+  if (!device_->SetDevicePollInterrupt()) {
+    return false;
+  }
+
   return true;
 }
 
@@ -250,17 +284,25 @@ void V4L2VideoEncoder::RunEncodeBufferTask() {
     return;
   }
 
-  DequeueBuffers();
+  MCIL_TRACE_EVENT("V4L2VideoEncoder::RunEncodeBufferTask");
+
+  // Only touch the queues the device poll found ready. Buffers that became
+  // ready since then make the next poll return right away.
+  DequeueReadyBuffers(
+      poll_ready_queues_.exchange(0, std::memory_order_acquire));
   EnqueueBuffers();
 
   // Clear the interrupt fd.
   if (!device_->ClearDevicePollInterrupt())
     return;
 
+  pending_frames_depth_.Sample(encoder_input_queue_.size());
+  input_queued_depth_.Sample(input_queue_->QueuedBuffersCount());
+  output_queued_depth_.Sample(output_queue_->QueuedBuffersCount());
+
   bool poll_device = ((input_queue_->QueuedBuffersCount() +
                        output_queue_->QueuedBuffersCount()) > 0);
-  device_poll_thread_.PostTask(std::bind(&V4L2VideoEncoder::DevicePollTask,
-                                         this, poll_device));
+  ScheduleDevicePollTask(poll_device);
 
   MCIL_DEBUG_PRINT(" [%ld] => DEVICE[%ld+%ld/%d->%ld+%ld/%ld] => OUT[%d]",
       encoder_input_queue_.size(), input_queue_->FreeBuffersCount(),
@@ -306,6 +348,7 @@ void V4L2VideoEncoder::EnqueueBuffers() {
         client_->NotifyFlushIfNeeded(true);
         return;
       }
+      MCIL_TRACE_INSTANT("V4L2VideoEncoder::SendEncoderCmdStop");
       struct v4l2_encoder_cmd cmd;
       memset(&cmd, 0, sizeof(cmd));
       cmd.cmd = V4L2_ENC_CMD_STOP;
@@ -319,7 +362,8 @@ void V4L2VideoEncoder::EnqueueBuffers() {
       break;
     }
 
-    Optional<V4L2WritableBufferRef> input = input_queue_->GetFreeBuffer();
+    Optional<V4L2WritableBufferRef> input =
+        GetFreeInputBuffer(*encoder_input_queue_.front().frame);
     if (!input)
       return;
 
@@ -362,17 +406,51 @@ bool V4L2VideoEncoder::NegotiateInputFormat(VideoPixelFormat format,
   return SetInputFormat(format, frame_size).has_value();
 }
 
+bool V4L2VideoEncoder::GetStats(EncoderStats* stats) {
+  if (stats == nullptr)
+    return false;
+
+  stats->input_wait = input_wait_histogram_.Snapshot();
+  stats->encode = encode_histogram_.Snapshot();
+  stats->deliver = deliver_histogram_.Snapshot();
+  stats->total = total_histogram_.Snapshot();
+  stats->pending_frames = pending_frames_depth_.Snapshot();
+  stats->input_queued = input_queued_depth_.Snapshot();
+  stats->output_queued = output_queued_depth_.Snapshot();
+  return true;
+}
+
 void V4L2VideoEncoder::DequeueBuffers() {
-  while (input_queue_->QueuedBuffersCount() > 0) {
-    if (!DequeueInputBuffer())
-      break;
+  DequeueReadyBuffers(V4L2Device::kAllQueuesReady);
+}
+
+void V4L2VideoEncoder::DequeueReadyBuffers(uint32_t ready_queues) {
+  if ((ready_queues & V4L2Device::kOutputQueueReady) != 0) {
+    while (input_queue_->QueuedBuffersCount() > 0) {
+      if (!DequeueInputBuffer())
+        break;
+    }
   }
 
   bool buffer_dequeued = false;
-  while (output_queue_->QueuedBuffersCount() > 0) {
-    if (!DequeueOutputBuffer())
-      break;
-    buffer_dequeued = true;
+  if ((ready_queues & V4L2Device::kCaptureQueueReady) != 0) {
+    while (output_queue_->QueuedBuffersCount() > 0) {
+      if (!DequeueOutputBuffer())
+        break;
+      buffer_dequeued = true;
+    }
+  }
+
+  if (!output_batch_.empty()) {
+    client_->BitstreamBuffersReady(output_batch_);
+    output_batch_.clear();
+
+    MonotonicTime delivered = std::chrono::steady_clock::now();
+    for (const auto& times : output_batch_times_) {
+      deliver_histogram_.Record(times.dequeue_time, delivered);
+      total_histogram_.Record(times.encode_time, delivered);
+    }
+    output_batch_times_.clear();
   }
 
   if (buffer_dequeued)
@@ -384,7 +462,8 @@ uint32_t V4L2VideoEncoder::GetCapsRequired() {
 }
 
 void V4L2VideoEncoder::InitInputMemoryType() {
-  input_memory_type_ = V4L2_MEMORY_MMAP;
+  input_memory_type_ = client_->UseDmabufInput() ?
+      V4L2_MEMORY_DMABUF : V4L2_MEMORY_MMAP;
 }
 
 void V4L2VideoEncoder::InitOutputMemoryType() {
@@ -622,6 +701,8 @@ bool V4L2VideoEncoder::CreateInputBuffers() {
   }
 
   size_t allocated = input_queue_->AllocatedBuffersCount();
+  input_buffer_fds_.clear();
+  input_buffer_fds_.resize(allocated);
   client_->CreateInputBuffers(allocated);
   input_buffer_created_ = true;
 
@@ -646,6 +727,7 @@ void V4L2VideoEncoder::DestroyInputBuffers() {
     return;
 
   input_queue_->DeallocateBuffers();
+  input_buffer_fds_.clear();
   client_->DestroyInputBuffers();
 }
 
@@ -673,10 +755,7 @@ bool V4L2VideoEncoder::EnqueueInputBuffer(V4L2WritableBufferRef buffer) {
   size_t buffer_index = buffer.BufferIndex();
   buffer.SetTimeStamp(frame->timestamp);
 
-  size_t num_planes = V4L2Device::GetNumPlanesOfV4L2PixFmt(
-      Fourcc::FromVideoPixelFormat(device_input_frame_->format,
-                                   !device_input_frame_->is_multi_planar)
-          ->ToV4L2PixFmt());
+  size_t num_planes = InputPlanesCount();
 
   for (size_t i = 0; i < num_planes; ++i) {
     size_t bytesused = 0;
@@ -702,6 +781,8 @@ bool V4L2VideoEncoder::EnqueueInputBuffer(V4L2WritableBufferRef buffer) {
       case V4L2_MEMORY_USERPTR:
         buffer.SetBufferSize(i, device_input_frame_->color_planes[i].size);
         break;
+      case V4L2_MEMORY_DMABUF:
+        break;
       default:
         return false;
     }
@@ -721,16 +802,58 @@ bool V4L2VideoEncoder::EnqueueInputBuffer(V4L2WritableBufferRef buffer) {
       std::move(buffer).QueueUserPtr(std::move(user_ptrs));
       break;
     }
+    case V4L2_MEMORY_DMABUF: {
+      InlineVector<int32_t, VideoFrame::kMaxPlanes> dmabuf_fds =
+          frame->dmabuf_fds;
+      if (!std::move(buffer).QueueDMABuf(std::move(frame))) {
+        MCIL_ERROR_PRINT(" Failed queueing dmabuf input");
+        NOTIFY_ERROR(kPlatformFailureError);
+        return false;
+      }
+      input_buffer_fds_[buffer_index] = dmabuf_fds;
+      break;
+    }
     default:
       return false;
   }
 
+  FrameTimes times;
+  times.encode_time = frame_info.encode_time;
+  times.queue_time = std::chrono::steady_clock::now();
+  input_wait_histogram_.Record(times.encode_time, times.queue_time);
+  device_frame_times_.push(times);
+
   client_->EnqueueInputBuffer(buffer_index);
   encoder_input_queue_.pop();
 
   return true;
 }
 
+Optional<V4L2WritableBufferRef> V4L2VideoEncoder::GetFreeInputBuffer(
+    const VideoFrame& frame) {
+  // vb2 keeps the last dmabuf of each buffer attached, and only re-imports
+  // it when a different one is queued there. A recycled fd number is just a
+  // miss, vb2 compares the dmabufs themselves.
+  if (input_memory_type_ == V4L2_MEMORY_DMABUF) {
+    for (size_t i = 0; i < input_buffer_fds_.size(); ++i) {
+      if (input_buffer_fds_[i] != frame.dmabuf_fds)
+        continue;
+      if (auto buffer = input_queue_->GetFreeBuffer(i))
+        return buffer;
+      break;
+    }
+  }
+
+  return input_queue_->GetFreeBuffer();
+}
+
+size_t V4L2VideoEncoder::InputPlanesCount() const {
+  return V4L2Device::GetNumPlanesOfV4L2PixFmt(
+      Fourcc::FromVideoPixelFormat(device_input_frame_->format,
+                                   !device_input_frame_->is_multi_planar)
+          ->ToV4L2PixFmt());
+}
+
 bool V4L2VideoEncoder::DequeueInputBuffer() {
   MCIL_DEBUG_PRINT(" inputs queued: %ld", input_queue_->QueuedBuffersCount());
 
@@ -787,32 +910,65 @@ bool V4L2VideoEncoder::DequeueOutputBuffer() {
     return false;
   }
 
-  if (start_time_ == ChronoTime())
-    start_time_ = std::chrono::system_clock::now();
+  MonotonicTime now = std::chrono::steady_clock::now();
+  if (start_time_ == MonotonicTime())
+    start_time_ = now;
 
   frames_per_sec_++;
-  std::chrono::duration<double> time_past =
-      std::chrono::system_clock::now() - start_time_;
+  std::chrono::duration<double> time_past = now - start_time_;
   if (time_past >= std::chrono::seconds(1)) {
     current_secs_++;
     MCIL_INFO_PRINT(": Encoder @ %d secs => %d fps",
                     current_secs_, frames_per_sec_);
-    start_time_ = std::chrono::system_clock::now();
+    start_time_ = now;
     frames_per_sec_ = 0;
   }
 
+  if (ret.second->IsLast())
+    MCIL_TRACE_INSTANT("V4L2VideoEncoder::LastOutputBuffer");
+
+  // An empty buffer only carries the LAST flag after a flush.
+  bool has_frame = (ret.second->GetBytesUsed(0) > 0) &&
+                   !device_frame_times_.empty();
+  FrameTimes times;
+  if (has_frame) {
+    times = device_frame_times_.front();
+    device_frame_times_.pop();
+    encode_histogram_.Record(times.queue_time, now);
+  }
+
+  if (batched_output_) {
+    output_batch_.push_back(std::move(ret.second));
+    if (has_frame) {
+      times.dequeue_time = now;
+      output_batch_times_.push_back(times);
+    }
+    return true;
+  }
+
   client_->BitstreamBufferReady(std::move(ret.second));
+
+  if (has_frame) {
+    MonotonicTime delivered = std::chrono::steady_clock::now();
+    deliver_histogram_.Record(now, delivered);
+    total_histogram_.Record(times.encode_time, delivered);
+  }
   return true;
 }
 
 bool V4L2VideoEncoder::StopDevicePoll() {
-  if (!device_poll_thread_.IsRunning())
+  if (!IsDevicePollRunning())
     return true;
 
-  if (!device_->SetDevicePollInterrupt())
-    return false;
+  if (shared_poller_ != nullptr) {
+    shared_poller_->Unregister(device_.get());
+    shared_poller_ = nullptr;
+  } else {
+    if (!device_->SetDevicePollInterrupt())
+      return false;
 
-  device_poll_thread_.Stop();
+    device_poll_loop_.Stop();
+  }
 
   if (!device_->ClearDevicePollInterrupt())
     return false;
@@ -830,6 +986,8 @@ bool V4L2VideoEncoder::StopDevicePoll() {
   // Reset all our accounting info.
   while (!encoder_input_queue_.empty())
     encoder_input_queue_.pop();
+  while (!device_frame_times_.empty())
+    device_frame_times_.pop();
 
   client_->StopDevicePoll();
 
@@ -838,13 +996,56 @@ bool V4L2VideoEncoder::StopDevicePoll() {
 }
 
 void V4L2VideoEncoder::DevicePollTask(bool poll_device) {
+  MCIL_TRACE_EVENT1("V4L2VideoEncoder::DevicePollTask", "poll_device",
+                    poll_device);
+
   bool event_pending;
-  if (!device_->Poll(poll_device, &event_pending)) {
+  uint32_t ready_queues = 0;
+  if (!device_->Poll(poll_device, &event_pending, &ready_queues)) {
     NOTIFY_ERROR(kPlatformFailureError);
     return;
   }
 
+  OnDevicePollDone(event_pending, ready_queues);
+}
+
+void V4L2VideoEncoder::OnDevicePollDone(bool event_pending,
+                                        uint32_t ready_queues) {
+  poll_ready_queues_.fetch_or(ready_queues, std::memory_order_release);
+  // The shared poller thread serves every codec of the process, it must
+  // not service this one nor wait for its client.
+  if ((direct_dispatch_lock_ != nullptr) && (shared_poller_ == nullptr) &&
+      RunDirectDispatch())
+    return;
+
   client_->NotifyEncodeBufferTask();
 }
 
+bool V4L2VideoEncoder::RunDirectDispatch() {
+  // The client may hold its lock for a while, even while stopping the
+  // device poll, so never wait for it. The caller takes the thread hop
+  // instead.
+  std::unique_lock<std::recursive_mutex> lock(*direct_dispatch_lock_,
+                                              std::try_to_lock);
+  if (!lock.owns_lock())
+    return false;
+
+  RunEncodeBufferTask();
+  return true;
+}
+
+bool V4L2VideoEncoder::IsDevicePollRunning() {
+  return (shared_poller_ != nullptr) || device_poll_loop_.IsRunning();
+}
+
+void V4L2VideoEncoder::ScheduleDevicePollTask(bool poll_device) {
+  if (shared_poller_ != nullptr) {
+    if (!shared_poller_->Arm(device_.get(), poll_device))
+      NOTIFY_ERROR(kPlatformFailureError);
+    return;
+  }
+
+  device_poll_loop_.Arm(poll_device);
+}
+
 }  // namespace mcil
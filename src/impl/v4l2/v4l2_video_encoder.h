@@ -5,16 +5,18 @@
 #ifndef SRC_IMPL_V4L2_V4L2_VIDEO_ENCODER_H_
 #define SRC_IMPL_V4L2_V4L2_VIDEO_ENCODER_H_
 
-#include "base/thread.h"
+#include "base/latency_histogram.h"
 #include "base/video_encoder.h"
 
 #include "v4l2/v4l2_buffers.h"
+#include "v4l2/v4l2_device_poll_loop.h"
 #include "v4l2/v4l2_utils.h"
 
 namespace mcil {
 
 class Fourcc;
 class V4L2Device;
+class V4L2DevicePoller;
 
 class V4L2VideoEncoder : public VideoEncoder {
  public:
@@ -43,6 +45,7 @@ class V4L2VideoEncoder : public VideoEncoder {
   virtual scoped_refptr<VideoFrame> GetDeviceInputFrame() override;
   virtual bool NegotiateInputFormat(VideoPixelFormat format,
                                     const Size& frame_size) override;
+  virtual bool GetStats(EncoderStats* stats) override;
 
  protected:
   // These are rather subjectively tuned.
@@ -58,9 +61,18 @@ class V4L2VideoEncoder : public VideoEncoder {
     ~InputFrameInfo() = default;
     scoped_refptr<VideoFrame> frame = nullptr;
     bool force_keyframe = false;
+    MonotonicTime encode_time;
+  };
+
+  struct FrameTimes {
+    MonotonicTime encode_time;
+    MonotonicTime queue_time;
+    MonotonicTime dequeue_time;
   };
 
   virtual void DequeueBuffers();
+  // Only dequeues from the queues in |ready_queues|.
+  virtual void DequeueReadyBuffers(uint32_t ready_queues);
   virtual uint32_t GetCapsRequired();
   virtual void InitInputMemoryType();
   virtual void InitOutputMemoryType();
@@ -89,6 +101,9 @@ class V4L2VideoEncoder : public VideoEncoder {
   virtual void DestroyInputBuffers();
   virtual void DestroyOutputBuffers();
 
+  // Prefers the input buffer |frame|'s dmabufs were last queued in.
+  Optional<V4L2WritableBufferRef> GetFreeInputBuffer(const VideoFrame& frame);
+  size_t InputPlanesCount() const;
   virtual bool EnqueueInputBuffer(V4L2WritableBufferRef buffer);
   virtual bool DequeueInputBuffer();
 
@@ -97,6 +112,12 @@ class V4L2VideoEncoder : public VideoEncoder {
 
   virtual bool StopDevicePoll();
   virtual void DevicePollTask(bool poll_device);
+  void OnDevicePollDone(bool event_pending, uint32_t ready_queues);
+  // Runs RunEncodeBufferTask() on the device poll thread, unless the client
+  // lock is taken. See DirectDispatchLock().
+  bool RunDirectDispatch();
+  bool IsDevicePollRunning();
+  void ScheduleDevicePollTask(bool poll_device);
 
   EncoderConfig encoder_config_ = {0};
 
@@ -119,19 +140,46 @@ class V4L2VideoEncoder : public VideoEncoder {
 
   scoped_refptr<VideoFrame> device_input_frame_;
   std::queue<InputFrameInfo> encoder_input_queue_;
+  // Frames queued to the device, oldest first. B frames are disabled, so
+  // bitstream buffers come back in the same order.
+  std::queue<FrameTimes> device_frame_times_;
 
   v4l2_memory input_memory_type_;
   v4l2_memory output_memory_type_;
+  // dmabuf fds last queued in each input buffer, in V4L2_MEMORY_DMABUF.
+  std::vector<InlineVector<int32_t, VideoFrame::kMaxPlanes>> input_buffer_fds_;
   bool inject_sps_and_pps_ = false;
 
-  Thread device_poll_thread_;
+  V4L2DevicePollLoop device_poll_loop_;
+  // Set instead of running |device_poll_loop_| when the device is polled
+  // by the shared V4L2DevicePoller.
+  V4L2DevicePoller* shared_poller_ = nullptr;
+  // Client lock held while servicing the device on the poll thread, when
+  // the client opted in to direct dispatch.
+  std::recursive_mutex* direct_dispatch_lock_ = nullptr;
+  // Ready queues reported by the polls completed since the last
+  // RunEncodeBufferTask().
+  std::atomic<uint32_t> poll_ready_queues_{0};
 
   VideoEncoderClient* client_ = nullptr;
+  // Bitstream buffers dequeued in this wake up, and the times of the frames
+  // they carry, when the client takes them in batches.
+  bool batched_output_ = false;
+  std::vector<ReadableBufferRef> output_batch_;
+  std::vector<FrameTimes> output_batch_times_;
 
-  ChronoTime start_time_;
+  MonotonicTime start_time_;
   uint32_t frames_per_sec_ = 0;
   uint32_t current_secs_ = 0;
 
+  LatencyHistogram input_wait_histogram_;
+  LatencyHistogram encode_histogram_;
+  LatencyHistogram deliver_histogram_;
+  LatencyHistogram total_histogram_;
+  QueueDepthCounter pending_frames_depth_;
+  QueueDepthCounter input_queued_depth_;
+  QueueDepthCounter output_queued_depth_;
+
   std::atomic<CodecState> encoder_state_{kUninitialized};
 };
 
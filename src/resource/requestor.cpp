@@ -24,6 +24,7 @@
 #include <cmath>
 
 #include "base/log.h"
+#include "base/trace_event.h"
 
 #if !defined(ENABLE_WRAPPER)
 using mrc::ResourceCalculator;
@@ -85,14 +86,33 @@ bool ResourceRequestor::AcquireResources(PortResource_t& resourceMMap,
   MCIL_DEBUG_PRINT("payload string = %s", payload.c_str());
 
   std::string response;
-  if (!umsRMC_->acquire(payload, response)) {
+  MonotonicTime rmc_start = std::chrono::steady_clock::now();
+  bool acquired;
+  {
+    MCIL_TRACE_EVENT("ResourceRequestor::RMCAcquire");
+    acquired = umsRMC_->acquire(payload, response);
+  }
+  rmc_call_histogram_.Record(rmc_start, std::chrono::steady_clock::now());
+  if (!acquired) {
     MCIL_ERROR_PRINT("fail to acquire!!! response : %s", response.c_str());
     return false;
   }
 
   try {
-    ParsePortInformation(response, resourceMMap);
-    ParseResources(response, resources);
+    MonotonicTime parse_start = std::chrono::steady_clock::now();
+    {
+      MCIL_TRACE_EVENT("ResourceRequestor::ParsePortInformation");
+      ParsePortInformation(response, resourceMMap);
+    }
+    MonotonicTime parse_end = std::chrono::steady_clock::now();
+    parse_ports_histogram_.Record(parse_start, parse_end);
+
+    {
+      MCIL_TRACE_EVENT("ResourceRequestor::ParseResources");
+      ParseResources(response, resources);
+    }
+    parse_resources_histogram_.Record(parse_end,
+                                      std::chrono::steady_clock::now());
   } catch (const std::runtime_error & err) {
     MCIL_ERROR_PRINT(" err=%s, response:%s", err.what(), response.c_str());
     return false;
@@ -132,15 +152,34 @@ bool ResourceRequestor::ReacquireResources(PortResource_t& resourceMMap,
   std::string response;
   // TODO: Enable for platform extensions selectively when available
 #if !defined(PLATFORM_EXTENSION)
-  if (!umsRMC_->reacquire(payload, response)) {
+  MonotonicTime rmc_start = std::chrono::steady_clock::now();
+  bool acquired;
+  {
+    MCIL_TRACE_EVENT("ResourceRequestor::RMCReacquire");
+    acquired = umsRMC_->reacquire(payload, response);
+  }
+  rmc_call_histogram_.Record(rmc_start, std::chrono::steady_clock::now());
+  if (!acquired) {
     MCIL_ERROR_PRINT("fail to acquire!!! response : %s", response.c_str());
     return false;
   }
 #endif
 
   try {
-    ParsePortInformation(response, resourceMMap);
-    ParseResources(response, resources);
+    MonotonicTime parse_start = std::chrono::steady_clock::now();
+    {
+      MCIL_TRACE_EVENT("ResourceRequestor::ParsePortInformation");
+      ParsePortInformation(response, resourceMMap);
+    }
+    MonotonicTime parse_end = std::chrono::steady_clock::now();
+    parse_ports_histogram_.Record(parse_start, parse_end);
+
+    {
+      MCIL_TRACE_EVENT("ResourceRequestor::ParseResources");
+      ParseResources(response, resources);
+    }
+    parse_resources_histogram_.Record(parse_end,
+                                      std::chrono::steady_clock::now());
   } catch (const std::runtime_error & err) {
     MCIL_ERROR_PRINT(" err=%s, response:%s", err.what(), response.c_str());
     return false;
@@ -208,6 +247,14 @@ void ResourceRequestor::AllowPolicyAction(const bool allow) {
   allowPolicy_ = allow;
 }
 
+void ResourceRequestor::GetStats(ResourceStats* stats) const {
+  stats->calculate = calculate_histogram_.Snapshot();
+  stats->build_request = build_request_histogram_.Snapshot();
+  stats->rmc_call = rmc_call_histogram_.Snapshot();
+  stats->parse_ports = parse_ports_histogram_.Snapshot();
+  stats->parse_resources = parse_resources_histogram_.Snapshot();
+}
+
 bool ResourceRequestor::PolicyActionHandler(const char *action,
                                             const char *resources,
                                             const char *requestorType,
@@ -231,8 +278,11 @@ bool ResourceRequestor::PolicyActionHandler(const char *action,
 
 std::string ResourceRequestor::GetSourceString(
     const source_info_t &sourceInfo) {
+  MCIL_TRACE_EVENT("ResourceRequestor::GetSourceString");
+
   std::string payload;
   mrc::ResourceListOptions finalOptions;
+  MonotonicTime calculate_start = std::chrono::steady_clock::now();
   if (!SetSourceInfo(sourceInfo)) {
     MCIL_ERROR_PRINT("Failed to set source info!");
     return payload;
@@ -254,6 +304,9 @@ std::string ResourceRequestor::GetSourceString(
         venc_resource[0].front().quantity);
   }
 
+  MonotonicTime build_start = std::chrono::steady_clock::now();
+  calculate_histogram_.Record(calculate_start, build_start);
+
   jvalue_ref arr = jarray_create(NULL);
   for (auto& option : finalOptions) {
     for (auto const& it : option) {
@@ -268,6 +321,8 @@ std::string ResourceRequestor::GetSourceString(
   }
 
   payload = (jvalue_stringify(arr) != NULL) ? jvalue_stringify(arr) : "";
+  build_request_histogram_.Record(build_start,
+                                  std::chrono::steady_clock::now());
   if (payload.empty()) {
     MCIL_ERROR_PRINT("Failed to set source info!");
     j_release(&arr);
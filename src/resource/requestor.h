@@ -26,6 +26,7 @@
 
 #include "base/decoder_types.h"
 #include "base/fourcc.h"
+#include "base/latency_histogram.h"
 
 #include "resource_wrapper/resource_calculator_wrapper.h"
 #include "resource_wrapper/resource_manager_client_wrapper.h"
@@ -109,6 +110,9 @@ class ResourceRequestor {
   bool NotifyBackground() const;
   void AllowPolicyAction(const bool allow);
 
+  // Fills the per phase latencies of all acquire requests so far.
+  void GetStats(ResourceStats* stats) const;
+
  private:
   bool SetSourceInfo(const source_info_t &sourceInfo);
   bool PolicyActionHandler(const char *action,
@@ -138,6 +142,12 @@ class ResourceRequestor {
   videoResData_t videoResData_;
 
   bool allowPolicy_;
+
+  LatencyHistogram calculate_histogram_;
+  LatencyHistogram build_request_histogram_;
+  LatencyHistogram rmc_call_histogram_;
+  LatencyHistogram parse_ports_histogram_;
+  LatencyHistogram parse_resources_histogram_;
 };
 
 }  // namespace MCIL
@@ -25,10 +25,40 @@
 #include <map>
 
 #include "base/log.h"
+#include "base/trace_event.h"
 #include "decoder_types.h"
 
 namespace mcil {
 
+namespace {
+
+// Records the duration of one Acquire()/Reacquire() call, and counts it as
+// failed unless set_succeeded() is called before it goes out of scope.
+class ScopedAcquireStats {
+ public:
+  ScopedAcquireStats(LatencyHistogram* total,
+                     std::atomic<uint64_t>* failures)
+      : total_(total),
+        failures_(failures),
+        start_(std::chrono::steady_clock::now()) {}
+
+  ~ScopedAcquireStats() {
+    total_->Record(start_, std::chrono::steady_clock::now());
+    if (!succeeded_)
+      failures_->fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void set_succeeded() { succeeded_ = true; }
+
+ private:
+  LatencyHistogram* total_;
+  std::atomic<uint64_t>* failures_;
+  MonotonicTime start_;
+  bool succeeded_ = false;
+};
+
+}  // namespace
+
 //Static member definition
 VideoResource& VideoResource::GetInstance() {
   static VideoResource rm_instance;
@@ -49,6 +79,7 @@ bool VideoResource::Acquire(DeviceType device_type,
                             uint32_t frame_rate,
                             std::string& resources,
                             int32_t *resource_index) {
+  MCIL_TRACE_EVENT("VideoResource::Acquire");
   MCIL_DEBUG_PRINT("[video info] width: %d, height: %d, frame_rate: %d",
                    frame_width, frame_height, frame_rate);
 
@@ -60,6 +91,7 @@ bool VideoResource::Acquire(DeviceType device_type,
   }
 #endif
 
+  ScopedAcquireStats acquire_stats(&total_histogram_, &failures_);
   if (!requestor_) {
     MCIL_ERROR_PRINT(" failed creating requestor_");
     return false;
@@ -71,7 +103,7 @@ bool VideoResource::Acquire(DeviceType device_type,
     return false;
   }
 
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::unique_lock<std::mutex> lock = Lock();
   requestor_->NotifyForeground();
   requestor_->RegisterUMSPolicyActionCallback([this]() {
       requestor_->NotifyBackground();
@@ -93,6 +125,7 @@ bool VideoResource::Acquire(DeviceType device_type,
     return false;
   }
 
+  acquire_stats.set_succeeded();
   return true;
 }
 
@@ -104,11 +137,13 @@ bool VideoResource::Reacquire(DeviceType device_type,
                               uint32_t frame_rate,
                               std::string& resources,
                               int32_t *resource_index) {
+  MCIL_TRACE_EVENT("VideoResource::Reacquire");
   MCIL_DEBUG_PRINT(" width: %d, height: %d, frame_rate: %d index: %d",
                    frame_width, frame_height, frame_rate, *resource_index);
 
   RemoveFromIndexList(device_type, *resource_index);
 
+  ScopedAcquireStats acquire_stats(&total_histogram_, &failures_);
   if (!requestor_) {
     MCIL_ERROR_PRINT(" failed creating requestor_");
     return false;
@@ -120,7 +155,7 @@ bool VideoResource::Reacquire(DeviceType device_type,
     return false;
   }
 
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::unique_lock<std::mutex> lock = Lock();
   requestor_->NotifyForeground();
   requestor_->RegisterUMSPolicyActionCallback([this]() {
       requestor_->NotifyBackground();
@@ -142,6 +177,7 @@ bool VideoResource::Reacquire(DeviceType device_type,
     return false;
   }
 
+  acquire_stats.set_succeeded();
   return true;
 }
 #endif
@@ -150,7 +186,7 @@ bool VideoResource::ReleaseVideoResource(DeviceType device_type,
                             int32_t resource_index) {
   MCIL_DEBUG_PRINT(" type: %d, index: %d", device_type, resource_index);
 
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::unique_lock<std::mutex> lock = Lock();
 
   RemoveFromIndexList(device_type, resource_index);
 
@@ -159,6 +195,19 @@ bool VideoResource::ReleaseVideoResource(DeviceType device_type,
   return false;
 }
 
+bool VideoResource::GetStats(ResourceStats* stats) const {
+  if (stats == nullptr)
+    return false;
+
+  if (requestor_)
+    requestor_->GetStats(stats);
+  stats->lock_wait = lock_wait_histogram_.Snapshot();
+  stats->total = total_histogram_.Snapshot();
+  stats->lock_contentions = lock_contentions_.load(std::memory_order_relaxed);
+  stats->failures = failures_.load(std::memory_order_relaxed);
+  return true;
+}
+
 bool VideoResource::GetSourceInfo(DeviceType device_type,
                                   VideoCodec video_codec,
                                   uint32_t frame_width,
@@ -227,6 +276,18 @@ bool VideoResource::AddToIndexList(PortResource_t resourceMMap,
   return true;
 }
 
+std::unique_lock<std::mutex> VideoResource::Lock() {
+  std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    MCIL_TRACE_EVENT("VideoResource::LockWait");
+    lock_contentions_.fetch_add(1, std::memory_order_relaxed);
+    MonotonicTime wait_start = std::chrono::steady_clock::now();
+    lock.lock();
+    lock_wait_histogram_.Record(wait_start, std::chrono::steady_clock::now());
+  }
+  return lock;
+}
+
 void VideoResource::RemoveFromIndexList(DeviceType device_type,
                                         int32_t resource_index) {
   if ((device_type == V4L2_DECODER) && (vdec_index_list_.empty() == false))
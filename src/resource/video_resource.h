@@ -17,11 +17,13 @@
 #ifndef SRC_RESOURCE_VIDEO_RESOURCE_H_
 #define SRC_RESOURCE_VIDEO_RESOURCE_H_
 
+#include <atomic>
 #include <mutex>
 #include <set>
 #include <thread>
 
 #include "base/decoder_types.h"
+#include "base/latency_histogram.h"
 #include "resource/requestor.h"
 
 namespace mcil {
@@ -62,6 +64,10 @@ class VideoResource {
                std::string& resources,
                int32_t resource_index);
 
+  // Per phase latencies of all Acquire()/Reacquire() calls in the process.
+  // Safe to call from any thread.
+  bool GetStats(ResourceStats* stats) const;
+
  private:
   VideoResource();
 
@@ -74,11 +80,18 @@ class VideoResource {
 
   bool AddToIndexList(PortResource_t resourceMMap, int32_t *resource_index);
   void RemoveFromIndexList(DeviceType device_type, int32_t resource_index);
+  // Locks |mutex_|, counting and timing the wait when another call holds it.
+  std::unique_lock<std::mutex> Lock();
 
   std::unique_ptr<ResourceRequestor> requestor_;
   std::set<int32_t> vdec_index_list_;
   std::set<int32_t> venc_index_list_;
   mutable std::mutex mutex_;
+
+  LatencyHistogram total_histogram_;
+  LatencyHistogram lock_wait_histogram_;
+  std::atomic<uint64_t> lock_contentions_{0};
+  std::atomic<uint64_t> failures_{0};
 };
 
 }  // namespace mcil